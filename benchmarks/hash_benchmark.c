@@ -0,0 +1,702 @@
+/*
+ * hash_benchmark.c
+ * Mediciones de latencia de busqueda para la Tabla de Hash.
+ *
+ * Compilar desde la raiz del repositorio:
+ *     gcc -O2 -std=c99 -pthread -I. -o hash_benchmark hash.c hash_set.c \
+ *         hash_snapshot.c benchmarks/hash_benchmark.c
+ * Uso:
+ *     ./hash_benchmark [exponente_max]
+ * Mide tablas de 10^3 hasta 10^exponente_max claves (por defecto 10^6)
+ * e imprime, en este orden, una tabla por cada comparacion:
+ *  - funcion/claves: cada funcion de hash con claves secuenciales y
+ *    adversarias; ns por insercion, acierto y fallo, colisiones y sondeo.
+ *  - rotacion: sondeo lineal, Robin Hood y por grupos bajo borrados.
+ *  - latencia: p99 y maximo por insercion, redimensionando de una vez o
+ *    de forma incremental.
+ *  - carga: guardar claves conocidas en un hash vacio, reservado o
+ *    construido en lote.
+ *  - lote de 64: busquedas en lote contra busquedas individuales.
+ *  - paralelo: guardar, construir en lote y destruir en un hilo y en
+ *    todos los procesadores.
+ *  - iterar: recorrer una tabla llena y una casi vacia.
+ *  - congelar: costo de congelar, y busquedas y bytes por clave antes y
+ *    despues.
+ *  - persistencia: volver a guardar todo contra escribir un snapshot y
+ *    mapearlo, y las busquedas en cada uno.
+ *  - claves de 64 bits: enteros pasados a texto en un hash_t contra un
+ *    hash generico de enteros.
+ *  - conjunto: un hash_t con datos NULL contra un hash_set_t.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "hash.h"
+#include "hash_generico.h"
+#include "hash_set.h"
+#include "hash_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LARGO_CLAVE 24
+#define CONSULTAS_MAX 1000000
+#define BLOQUES_ADVERSARIOS 10
+#define ADVERSARIAS_MAX 1000
+#define VUELTAS_ROTACION 4
+#define LOTE 64
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static double ahora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// Generador congruencial simple: reproducible entre corridas.
+static size_t siguiente(size_t* estado)
+{
+    *estado = *estado * 6364136223846793005u + 1442695040888963407u;
+    return *estado >> 17;
+}
+
+// Evita que el compilador descarte las busquedas.
+static volatile size_t sumidero;
+
+static double medir_obtener(const hash_t* hash, char (*claves)[LARGO_CLAVE],
+                            size_t largo, size_t consultas)
+{
+    size_t estado = 42;
+    size_t encontrados = 0;
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < consultas; i++) {
+        encontrados += hash_obtener(hash, claves[siguiente(&estado) % largo]) != NULL;
+    }
+    double fin = ahora_ns();
+    sumidero += encontrados;
+    return (fin - inicio) / (double) consultas;
+}
+
+// Claves "clave0000000000", "clave0000000001", ...
+static void clave_secuencial(char* clave, const char* prefijo, size_t i)
+{
+    snprintf(clave, LARGO_CLAVE, "%s%010zu", prefijo, i);
+}
+
+/* Claves armadas con bloques "Aa" y "BB", que valen lo mismo en el
+ * polinomio 31*h + c: todas colisionan con HASH_FUNCION_CLASICA. */
+static void clave_adversaria(char* clave, const char* prefijo, size_t i)
+{
+    size_t largo = 0;
+    clave[largo++] = prefijo[0];
+    for (size_t b = 0; b < BLOQUES_ADVERSARIOS; b++, i >>= 1) {
+        clave[largo++] = (i & 1) ? 'B' : 'A';
+        clave[largo++] = (i & 1) ? 'B' : 'a';
+    }
+    clave[largo] = '\0';
+}
+
+typedef void (*generar_clave_t)(char* clave, const char* prefijo, size_t i);
+
+/* ******************************************************************
+ *                        BENCHMARKS
+ * *****************************************************************/
+
+static void benchmark_busquedas(const char* nombre, const hash_opciones_t* opciones,
+                                generar_clave_t generar, size_t largo)
+{
+    char (*presentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    char (*ausentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+    if (!presentes || !ausentes || !hash) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(presentes);
+        free(ausentes);
+        if (hash) hash_destruir(hash);
+        return;
+    }
+
+    for (size_t i = 0; i < largo; i++) {
+        generar(presentes[i], "c", i);
+        generar(ausentes[i], "f", i);
+    }
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < largo; i++) {
+        hash_guardar(hash, presentes[i], presentes[i]);
+    }
+    double ns_insercion = (ahora_ns() - inicio) / (double) largo;
+
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    double ns_acierto = medir_obtener(hash, presentes, largo, consultas);
+    double ns_fallo = medir_obtener(hash, ausentes, largo, consultas);
+    hash_informe_sondeo_t informe;
+    hash_informe_sondeo(hash, &informe);
+    printf("%-22s %10zu %12.1f %12.1f %12.1f %12zu %10.2f %10zu\n", nombre, largo, ns_insercion,
+           ns_acierto, ns_fallo, informe.colisiones, informe.largo_promedio, informe.largo_max);
+
+    hash_destruir(hash);
+    free(presentes);
+    free(ausentes);
+}
+
+/* Carga de borrado: mantiene 'largo' claves vivas borrando siempre la mas
+ * vieja e insertando una nueva, 'vueltas' veces la cantidad de claves.
+ * Luego mide las busquedas sobre la tabla que quedo. */
+static void benchmark_rotacion(const char* nombre, const hash_opciones_t* opciones,
+                               size_t largo, size_t vueltas)
+{
+    char (*presentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    char (*ausentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+    if (!presentes || !ausentes || !hash) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(presentes);
+        free(ausentes);
+        if (hash) hash_destruir(hash);
+        return;
+    }
+
+    char clave[LARGO_CLAVE];
+    size_t total = largo * (vueltas + 1);
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < total; i++) {
+        if (i >= largo) {
+            clave_secuencial(clave, "c", i - largo);
+            hash_borrar(hash, clave);
+        }
+        clave_secuencial(clave, "c", i);
+        hash_guardar(hash, clave, hash);
+    }
+    double ns_rotacion = (ahora_ns() - inicio) / (double) total;
+
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(presentes[i], "c", total - largo + i);
+        clave_secuencial(ausentes[i], "f", i);
+    }
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    double ns_acierto = medir_obtener(hash, presentes, largo, consultas);
+    double ns_fallo = medir_obtener(hash, ausentes, largo, consultas);
+    hash_informe_sondeo_t informe;
+    hash_informe_sondeo(hash, &informe);
+    printf("%-22s %10zu %12.1f %12.1f %12.1f %10.2f %10zu\n", nombre, largo,
+           ns_rotacion, ns_acierto, ns_fallo, informe.largo_promedio, informe.largo_max);
+
+    hash_destruir(hash);
+    free(presentes);
+    free(ausentes);
+}
+
+static int comparar_double(const void* a, const void* b)
+{
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+/* Mide cada insercion por separado: con redimensionado de una vez las que
+ * disparan el crecimiento tardan en proporcion al tamaño de la tabla. */
+static void benchmark_latencia(const char* nombre, const hash_opciones_t* opciones, size_t largo)
+{
+    double* latencias = malloc(largo * sizeof(double));
+    hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+    if (!latencias || !hash) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(latencias);
+        if (hash) hash_destruir(hash);
+        return;
+    }
+
+    char clave[LARGO_CLAVE];
+    double total = 0;
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(clave, "c", i);
+        double inicio = ahora_ns();
+        hash_guardar(hash, clave, hash);
+        latencias[i] = ahora_ns() - inicio;
+        total += latencias[i];
+    }
+    qsort(latencias, largo, sizeof(double), comparar_double);
+    printf("%-22s %10zu %12.1f %12.1f %12.1f %14.1f\n", nombre, largo, total / (double) largo,
+           latencias[largo / 2], latencias[largo - 1 - largo / 100], latencias[largo - 1]);
+
+    hash_destruir(hash);
+    free(latencias);
+}
+
+/* Tiempo por clave para cargar 'largo' claves distintas de tres formas. */
+static void benchmark_carga(size_t largo)
+{
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    const char** punteros = malloc(largo * sizeof(char*));
+    if (!claves || !punteros) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(claves);
+        free(punteros);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(claves[i], "c", i);
+        punteros[i] = claves[i];
+    }
+    // Una carga previa sin medir, para que las tres encuentren la memoria
+    // del proceso en el mismo estado.
+    hash_t* hash = hash_construir_lote(punteros, NULL, largo, NULL);
+    hash_destruir(hash);
+
+    double inicio = ahora_ns();
+    hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], NULL);
+    double ns_vacio = (ahora_ns() - inicio) / (double) largo;
+    hash_destruir(hash);
+
+    inicio = ahora_ns();
+    hash = hash_crear_con_capacidad(largo, NULL);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], NULL);
+    double ns_reservado = (ahora_ns() - inicio) / (double) largo;
+    hash_destruir(hash);
+
+    inicio = ahora_ns();
+    hash = hash_construir_lote(punteros, NULL, largo, NULL);
+    double ns_lote = (ahora_ns() - inicio) / (double) largo;
+    hash_destruir(hash);
+
+    printf("%-22s %10zu %12.1f %12.1f %12.1f\n", "carga", largo, ns_vacio, ns_reservado, ns_lote);
+    free(punteros);
+    free(claves);
+}
+
+/* Resuelve consultas al azar de a LOTE claves, con hash_obtener_lote y con
+ * un ciclo de hash_obtener. */
+static void benchmark_lote(size_t largo)
+{
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    const char** consultas = malloc(CONSULTAS_MAX * sizeof(char*));
+    void** resultados = malloc(CONSULTAS_MAX * sizeof(void*));
+    hash_t* hash = hash_crear(NULL);
+    if (!claves || !consultas || !resultados || !hash) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(claves);
+        free(consultas);
+        free(resultados);
+        if (hash) hash_destruir(hash);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(claves[i], "c", i);
+        hash_guardar(hash, claves[i], claves[i]);
+    }
+    size_t estado = 42;
+    for (size_t i = 0; i < CONSULTAS_MAX; i++) consultas[i] = claves[siguiente(&estado) % largo];
+
+    size_t encontrados = 0;
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < CONSULTAS_MAX; i += LOTE) {
+        for (size_t j = i; j < i + LOTE && j < CONSULTAS_MAX; j++) {
+            resultados[j] = hash_obtener(hash, consultas[j]);
+        }
+        encontrados += resultados[i] != NULL;
+    }
+    double ns_individual = (ahora_ns() - inicio) / CONSULTAS_MAX;
+
+    inicio = ahora_ns();
+    for (size_t i = 0; i < CONSULTAS_MAX; i += LOTE) {
+        size_t n = CONSULTAS_MAX - i < LOTE ? CONSULTAS_MAX - i : LOTE;
+        hash_obtener_lote(hash, consultas + i, n, resultados + i);
+        encontrados += resultados[i] != NULL;
+    }
+    double ns_lote = (ahora_ns() - inicio) / CONSULTAS_MAX;
+    sumidero += encontrados;
+
+    printf("%-22s %10zu %12.1f %12.1f %10.2fx\n", "obtener", largo, ns_individual, ns_lote,
+           ns_individual / ns_lote);
+    hash_destruir(hash);
+    free(claves);
+    free(consultas);
+    free(resultados);
+}
+
+/* Mide en ms guardar 'largo' claves de a una, construir la misma tabla en
+ * lote y destruirla liberando cada valor, con las opciones dadas. */
+static void benchmark_paralelo(const char* nombre, const hash_opciones_t* opciones, size_t largo)
+{
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** valores = malloc(largo * sizeof(void*));
+    if (!claves || !punteros || !valores) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(claves);
+        free(punteros);
+        free(valores);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(claves[i], "c", i);
+        punteros[i] = claves[i];
+    }
+
+    double inicio = ahora_ns();
+    hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], NULL);
+    double ms_guardar = (ahora_ns() - inicio) / 1e6;
+    hash_destruir(hash);
+
+    for (size_t i = 0; i < largo; i++) valores[i] = malloc(sizeof(size_t));
+    inicio = ahora_ns();
+    hash = hash_construir_lote_con_opciones(punteros, valores, largo, free, opciones);
+    double ms_lote = (ahora_ns() - inicio) / 1e6;
+
+    inicio = ahora_ns();
+    hash_destruir(hash);
+    double ms_destruir = (ahora_ns() - inicio) / 1e6;
+
+    printf("%-22s %10zu %12.1f %12.1f %12.1f\n", nombre, largo, ms_guardar, ms_lote, ms_destruir);
+    free(valores);
+    free(punteros);
+    free(claves);
+}
+
+/* Mide en ns por posicion recorrer con el iterador una tabla con 'largo'
+ * claves, llena o reservada para 100 veces mas claves (casi vacia). */
+static void benchmark_iterar(const char* nombre, const hash_opciones_t* opciones, size_t largo)
+{
+    char clave[LARGO_CLAVE];
+    double ns[2];
+    for (size_t vacia = 0; vacia < 2; vacia++) {
+        hash_opciones_t con_capacidad = *opciones;
+        con_capacidad.capacidad = vacia ? largo * 100 : 0;
+        hash_t* hash = hash_crear_con_opciones(NULL, &con_capacidad);
+        for (size_t i = 0; i < largo; i++) {
+            clave_secuencial(clave, "c", i);
+            hash_guardar(hash, clave, NULL);
+        }
+        size_t recorridos = 0;
+        double inicio = ahora_ns();
+        hash_iter_t* iter = hash_iter_crear(hash);
+        for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) recorridos++;
+        hash_iter_destruir(iter);
+        ns[vacia] = (ahora_ns() - inicio) / (double) hash_posiciones(hash);
+        sumidero += recorridos;
+        hash_destruir(hash);
+    }
+    printf("%-22s %10zu %12.2f %12.2f\n", nombre, largo, ns[0], ns[1]);
+}
+
+/* Mide en ms reconstruir un hash de 'largo' claves guardandolas de nuevo,
+ * escribir su snapshot y cargarlo con mmap, y en ns un acierto en el hash
+ * y en el mapa. */
+static void benchmark_snapshot(size_t largo)
+{
+    const char* ruta = "hash_benchmark.snapshot";
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    if (!claves) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) clave_secuencial(claves[i], "c", i);
+
+    double inicio = ahora_ns();
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], (void*) (i + 1));
+    double ms_reconstruir = (ahora_ns() - inicio) / 1e6;
+
+    inicio = ahora_ns();
+    bool guardado = hash_guardar_snapshot(hash, ruta, 0);
+    double ms_guardar = (ahora_ns() - inicio) / 1e6;
+    inicio = ahora_ns();
+    hash_mapa_t* mapa = guardado ? hash_cargar_mmap(ruta) : NULL;
+    double ms_cargar = (ahora_ns() - inicio) / 1e6;
+    if (!mapa) {
+        fprintf(stderr, "No se pudo escribir o cargar %s\n", ruta);
+        hash_destruir(hash);
+        free(claves);
+        return;
+    }
+
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    double ns_hash = medir_obtener(hash, claves, largo, consultas);
+    size_t estado = 42;
+    size_t encontrados = 0;
+    inicio = ahora_ns();
+    for (size_t i = 0; i < consultas; i++) {
+        encontrados += hash_mapa_obtener(mapa, claves[siguiente(&estado) % largo]) != NULL;
+    }
+    double ns_mapa = (ahora_ns() - inicio) / (double) consultas;
+    sumidero += encontrados;
+
+    printf("%-22s %10zu %12.1f %12.1f %12.3f %12.1f %12.1f\n", "snapshot", largo, ms_reconstruir,
+           ms_guardar, ms_cargar, ns_hash, ns_mapa);
+    hash_mapa_cerrar(mapa);
+    hash_destruir(hash);
+    remove(ruta);
+    free(claves);
+}
+
+/* Mide en ms congelar un hash de 'largo' claves, y compara antes y despues
+ * los ns por acierto y por fallo y los bytes por clave de la tabla. */
+static void benchmark_congelar(size_t largo)
+{
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    char (*ausentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    if (!claves || !ausentes) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(claves);
+        free(ausentes);
+        return;
+    }
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(claves[i], "c", i);
+        clave_secuencial(ausentes[i], "x", i);
+        hash_guardar(hash, claves[i], claves[i]);
+    }
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    hash_memoria_t memoria;
+    hash_memoria(hash, &memoria);
+    double bytes_antes = (double) memoria.bytes_campos / (double) largo;
+    double acierto_antes = medir_obtener(hash, claves, largo, consultas);
+    double fallo_antes = medir_obtener(hash, ausentes, largo, consultas);
+
+    double inicio = ahora_ns();
+    bool congelado = hash_congelar(hash);
+    double ms_congelar = (ahora_ns() - inicio) / 1e6;
+    hash_memoria(hash, &memoria);
+    double bytes_despues = (double) memoria.bytes_campos / (double) largo;
+    double acierto_despues = medir_obtener(hash, claves, largo, consultas);
+    double fallo_despues = medir_obtener(hash, ausentes, largo, consultas);
+
+    printf("%-22s %10zu %12.1f %8.1f/%-6.1f %8.1f/%-6.1f %8.1f/%-6.1f\n",
+           congelado ? "congelado" : "no se congelo", largo, ms_congelar, acierto_antes,
+           acierto_despues, fallo_antes, fallo_despues, bytes_antes, bytes_despues);
+    hash_destruir(hash);
+    free(claves);
+    free(ausentes);
+}
+
+HASH_DEFINIR(hash_enteros, uint64_t, uint64_t, hash_entero, hash_entero_igual)
+
+/* Guarda 'largo' enteros al azar en un hash_t, escritos como texto, y en
+ * un hash_enteros_t, y compara ns por insercion y por acierto (en hash_t
+ * incluye escribir la clave) y bytes por clave. */
+static void benchmark_enteros(size_t largo)
+{
+    uint64_t* ids = malloc(largo * sizeof(uint64_t));
+    hash_t* hash = hash_crear(NULL);
+    hash_enteros_t* enteros = hash_enteros_crear();
+    if (!ids || !hash || !enteros) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(ids);
+        if (hash) hash_destruir(hash);
+        if (enteros) hash_enteros_destruir(enteros);
+        return;
+    }
+    size_t estado = 7;
+    for (size_t i = 0; i < largo; i++) ids[i] = (uint64_t) siguiente(&estado) << 20 ^ siguiente(&estado);
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    char clave[LARGO_CLAVE];
+
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < largo; i++) {
+        snprintf(clave, LARGO_CLAVE, "%llu", (unsigned long long) ids[i]);
+        hash_guardar(hash, clave, NULL);
+    }
+    double ns_texto = (ahora_ns() - inicio) / (double) largo;
+    inicio = ahora_ns();
+    for (size_t i = 0; i < largo; i++) hash_enteros_guardar(enteros, ids[i], i);
+    double ns_enteros = (ahora_ns() - inicio) / (double) largo;
+
+    size_t encontrados = 0;
+    estado = 42;
+    inicio = ahora_ns();
+    for (size_t i = 0; i < consultas; i++) {
+        snprintf(clave, LARGO_CLAVE, "%llu", (unsigned long long) ids[siguiente(&estado) % largo]);
+        encontrados += hash_pertenece(hash, clave);
+    }
+    double acierto_texto = (ahora_ns() - inicio) / (double) consultas;
+    estado = 42;
+    inicio = ahora_ns();
+    for (size_t i = 0; i < consultas; i++) {
+        encontrados += hash_enteros_obtener(enteros, ids[siguiente(&estado) % largo]) != NULL;
+    }
+    double acierto_enteros = (ahora_ns() - inicio) / (double) consultas;
+    sumidero += encontrados;
+
+    hash_memoria_t memoria;
+    hash_memoria(hash, &memoria);
+    double bytes_texto = (double) memoria.bytes_total / (double) largo;
+    double bytes_enteros = (double) (enteros->capacidad * (sizeof(hash_enteros_campo_t) + 1)) / (double) largo;
+
+    printf("%-22s %10zu %8.1f/%-6.1f %8.1f/%-6.1f %8.1f/%-6.1f\n", "texto/enteros", largo, ns_texto,
+           ns_enteros, acierto_texto, acierto_enteros, bytes_texto, bytes_enteros);
+    hash_destruir(hash);
+    hash_enteros_destruir(enteros);
+    free(ids);
+}
+
+/* Compara un hash_t usado como conjunto (datos NULL) con un hash_set_t de
+ * las mismas claves: ns por acierto y por fallo y bytes por clave. */
+static void benchmark_set(size_t largo)
+{
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    char (*ausentes)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    hash_t* hash = hash_crear(NULL);
+    hash_set_t* set = hash_set_crear();
+    if (!claves || !ausentes || !hash || !set) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        free(claves);
+        free(ausentes);
+        if (hash) hash_destruir(hash);
+        if (set) hash_set_destruir(set);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) {
+        clave_secuencial(claves[i], "c", i);
+        clave_secuencial(ausentes[i], "x", i);
+        hash_guardar(hash, claves[i], NULL);
+        hash_set_guardar(set, claves[i]);
+    }
+    size_t consultas = largo < CONSULTAS_MAX ? largo : CONSULTAS_MAX;
+    double ns[4];
+    char (*fuentes[])[LARGO_CLAVE] = {claves, ausentes};
+    for (size_t f = 0; f < 2; f++) {
+        size_t encontrados = 0, estado = 42;
+        double inicio = ahora_ns();
+        for (size_t i = 0; i < consultas; i++) {
+            encontrados += hash_pertenece(hash, fuentes[f][siguiente(&estado) % largo]);
+        }
+        ns[2 * f] = (ahora_ns() - inicio) / (double) consultas;
+        estado = 42;
+        inicio = ahora_ns();
+        for (size_t i = 0; i < consultas; i++) {
+            encontrados += hash_set_pertenece(set, fuentes[f][siguiente(&estado) % largo]);
+        }
+        ns[2 * f + 1] = (ahora_ns() - inicio) / (double) consultas;
+        sumidero += encontrados;
+    }
+    hash_memoria_t memoria;
+    hash_memoria(hash, &memoria);
+
+    printf("%-22s %10zu %8.1f/%-6.1f %8.1f/%-6.1f %8.1f/%-6.1f\n", "hash/set", largo, ns[0], ns[1], ns[2],
+           ns[3], (double) memoria.bytes_total / (double) largo, (double) hash_set_memoria(set) / (double) largo);
+    hash_destruir(hash);
+    hash_set_destruir(set);
+    free(claves);
+    free(ausentes);
+}
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+int main(int argc, char *argv[])
+{
+    long exponente_max = 6;
+    if (argc > 1) exponente_max = strtol(argv[1], NULL, 10);
+
+    hash_opciones_t rapida = {0};
+    hash_opciones_t clasica = {0};
+    clasica.funcion = HASH_FUNCION_CLASICA;
+    hash_opciones_t grupos = {0};
+    grupos.sondeo = HASH_SONDEO_GRUPOS;
+
+    printf("%-22s %10s %12s %12s %12s %12s %10s %10s\n", "funcion/claves", "claves",
+           "ns/insercion", "ns/acierto", "ns/fallo", "colisiones", "sondeo", "sondeo max");
+    size_t largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_busquedas("rapida/secuencial", &rapida, clave_secuencial, largo);
+        benchmark_busquedas("clasica/secuencial", &clasica, clave_secuencial, largo);
+        benchmark_busquedas("grupos/secuencial", &grupos, clave_secuencial, largo);
+    }
+    /* Con la funcion clasica cada busqueda recorre todas las claves:
+     * se limita el tamaño para que termine. */
+    for (largo = 1000; largo <= ADVERSARIAS_MAX; largo *= 10) {
+        benchmark_busquedas("rapida/adversaria", &rapida, clave_adversaria, largo);
+        benchmark_busquedas("clasica/adversaria", &clasica, clave_adversaria, largo);
+    }
+
+    hash_opciones_t robin_hood = {0};
+    robin_hood.sondeo = HASH_SONDEO_ROBIN_HOOD;
+    printf("\n%-22s %10s %12s %12s %12s %10s %10s\n", "rotacion", "claves",
+           "ns/rotacion", "ns/acierto", "ns/fallo", "sondeo", "sondeo max");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_rotacion("lineal", &rapida, largo, VUELTAS_ROTACION);
+        benchmark_rotacion("robin hood", &robin_hood, largo, VUELTAS_ROTACION);
+        benchmark_rotacion("grupos", &grupos, largo, VUELTAS_ROTACION);
+    }
+
+    hash_opciones_t incremental = {0};
+    incremental.incremental = true;
+    printf("\n%-22s %10s %12s %12s %12s %14s\n", "latencia", "claves",
+           "ns/promedio", "ns/p50", "ns/p99", "ns/max");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_latencia("de una vez", &rapida, largo);
+        benchmark_latencia("incremental", &incremental, largo);
+    }
+
+    printf("\n%-22s %10s %12s %12s %12s\n", "carga", "claves",
+           "ns/vacio", "ns/reservado", "ns/lote");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_carga(largo);
+    }
+
+    printf("\n%-22s %10s %12s %12s %11s\n", "lote de 64", "claves",
+           "ns/individual", "ns/lote", "mejora");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_lote(largo);
+    }
+
+    hash_opciones_t paralelo = {0};
+    paralelo.hilos = (size_t) sysconf(_SC_NPROCESSORS_ONLN);
+    paralelo.destruir_en_paralelo = true;
+    printf("\n%-22s %10s %12s %12s %12s   (%zu hilos)\n", "paralelo", "claves",
+           "ms/guardar", "ms/lote", "ms/destruir", paralelo.hilos);
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_paralelo("un hilo", &rapida, largo);
+        benchmark_paralelo("todos los hilos", &paralelo, largo);
+    }
+
+    printf("\n%-22s %10s %12s %12s\n", "iterar", "claves", "ns/pos llena", "ns/pos vacia");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max - 1; e++, largo *= 10) {
+        benchmark_iterar("lineal", &rapida, largo);
+        benchmark_iterar("grupos", &grupos, largo);
+    }
+
+    printf("\n%-22s %10s %12s %15s %15s %15s\n", "congelar", "claves", "ms/congelar",
+           "ns/acierto a/d", "ns/fallo a/d", "bytes/clave a/d");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_congelar(largo);
+    }
+
+    printf("\n%-22s %10s %12s %12s %12s %12s %12s\n", "persistencia", "claves",
+           "ms/reconst.", "ms/snapshot", "ms/mmap", "ns/hash", "ns/mapa");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_snapshot(largo);
+    }
+
+    printf("\n%-22s %10s %15s %15s %15s\n", "claves de 64 bits", "claves", "ns/guardar t/e",
+           "ns/acierto t/e", "bytes/clave t/e");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_enteros(largo);
+    }
+
+    printf("\n%-22s %10s %15s %15s %15s\n", "conjunto", "claves", "ns/acierto h/s",
+           "ns/fallo h/s", "bytes/clave h/s");
+    largo = 1000;
+    for (long e = 3; e <= exponente_max; e++, largo *= 10) {
+        benchmark_set(largo);
+    }
+    return 0;
+}
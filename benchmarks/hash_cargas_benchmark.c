@@ -0,0 +1,532 @@
+/*
+ * hash_cargas_benchmark.c
+ * Cargas de trabajo reproducibles para la Tabla de Hash, pensadas para
+ * comparar versiones: pruebas_volumen_catedra verifica que el hash
+ * funcione con muchas claves, esto mide cuanto tarda.
+ *
+ * Compilar desde la raiz del repositorio:
+ *     gcc -O2 -std=c99 -pthread -I. -o hash_cargas_benchmark hash.c \
+ *         benchmarks/hash_cargas_benchmark.c -lm
+ * Uso:
+ *     ./hash_cargas_benchmark [-n claves] [-o operaciones] [-r repeticiones]
+ *         [-w calentamiento] [-c carga] [-a aciertos] [-z zipf]
+ *         [-l largos] [-s sondeo] [-i] [-m semilla] [-f formato]
+ *
+ *   -n claves en la tabla (10^6)
+ *   -o operaciones por corrida en las cargas de busqueda y rotacion (10^6)
+ *   -r corridas medidas (5) y -w corridas de calentamiento antes (1)
+ *   -c una sola carga: insercion, aciertos, fallos, mixta, zipf o
+ *      rotacion (todas)
+ *   -a porcentaje de aciertos de la carga mixta (50)
+ *   -z exponente de la carga zipf (0.99)
+ *   -l largos de las claves: fijo (16 bytes), uniforme (de 8 a 64) o
+ *      mezcla (80% de hasta 15 bytes, que entran en el campo, y 20% de
+ *      40 a 100) (fijo)
+ *   -s sondeo: lineal, grupos o robin_hood (lineal); -i redimensiona
+ *      incremental
+ *   -m semilla de las claves, de las operaciones y del hash (1)
+ *   -f salida: texto, csv o json (texto)
+ *
+ * Cada carga arma la tabla de nuevo en cada corrida. Informa la mediana,
+ * el minimo y el maximo de ns por operacion entre corridas, percentiles
+ * de latencia de una corrida aparte con cada operacion medida (sin el
+ * costo de leer el reloj) y el pico de memoria residente del proceso
+ * hasta ese momento: para el pico de una sola carga, correrla sola con -c.
+ * Los percentiles son de operaciones aisladas por las lecturas del reloj,
+ * asi que pueden superar los ns/op: sin medir cada una, el procesador
+ * superpone las esperas a memoria de operaciones seguidas.
+ * Con la misma semilla y opciones las operaciones son las mismas en cada
+ * ejecucion.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "hash.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PERCENTILES 5
+
+/* ******************************************************************
+ *                        CONFIGURACION
+ * *****************************************************************/
+
+typedef enum largos { LARGOS_FIJO, LARGOS_UNIFORME, LARGOS_MEZCLA } largos_t;
+typedef enum formato { FORMATO_TEXTO, FORMATO_CSV, FORMATO_JSON } formato_t;
+typedef enum operacion { OPERACION_GUARDAR, OPERACION_OBTENER, OPERACION_ROTAR } operacion_t;
+
+typedef struct config {
+    size_t claves;
+    size_t operaciones;
+    size_t repeticiones;
+    size_t calentamiento;
+    const char* carga;          // NULL: todas
+    unsigned aciertos;
+    double zipf;
+    largos_t largos;
+    hash_sondeo_t sondeo;
+    bool incremental;
+    size_t semilla;
+    formato_t formato;
+} config_t;
+
+static const char* NOMBRES_LARGOS[] = {"fijo", "uniforme", "mezcla"};
+static const char* NOMBRES_SONDEO[] = {"lineal", "robin_hood", "grupos"};
+static const double PERCENTIL[PERCENTILES] = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+// Busca nombre en nombres; devuelve su indice o -1.
+static int buscar_nombre(const char* nombre, const char** nombres, int cantidad)
+{
+    for (int i = 0; i < cantidad; i++) {
+        if (strcmp(nombre, nombres[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static bool leer_config(int argc, char* argv[], config_t* config)
+{
+    config->claves = 1000000;
+    config->operaciones = 1000000;
+    config->repeticiones = 5;
+    config->calentamiento = 1;
+    config->carga = NULL;
+    config->aciertos = 50;
+    config->zipf = 0.99;
+    config->largos = LARGOS_FIJO;
+    config->sondeo = HASH_SONDEO_LINEAL;
+    config->incremental = false;
+    config->semilla = 1;
+    config->formato = FORMATO_TEXTO;
+
+    const char* formatos[] = {"texto", "csv", "json"};
+    int opcion, indice;
+    while ((opcion = getopt(argc, argv, "n:o:r:w:c:a:z:l:s:im:f:")) != -1) {
+        switch (opcion) {
+        case 'n': config->claves = strtoul(optarg, NULL, 10); break;
+        case 'o': config->operaciones = strtoul(optarg, NULL, 10); break;
+        case 'r': config->repeticiones = strtoul(optarg, NULL, 10); break;
+        case 'w': config->calentamiento = strtoul(optarg, NULL, 10); break;
+        case 'c': config->carga = optarg; break;
+        case 'a': config->aciertos = (unsigned) strtoul(optarg, NULL, 10); break;
+        case 'z': config->zipf = strtod(optarg, NULL); break;
+        case 'i': config->incremental = true; break;
+        case 'm': config->semilla = strtoul(optarg, NULL, 10); break;
+        case 'l':
+            if ((indice = buscar_nombre(optarg, NOMBRES_LARGOS, 3)) < 0) return false;
+            config->largos = (largos_t) indice;
+            break;
+        case 's':
+            if ((indice = buscar_nombre(optarg, NOMBRES_SONDEO, 3)) < 0) return false;
+            config->sondeo = (hash_sondeo_t) indice;
+            break;
+        case 'f':
+            if ((indice = buscar_nombre(optarg, formatos, 3)) < 0) return false;
+            config->formato = (formato_t) indice;
+            break;
+        default: return false;
+        }
+    }
+    return config->claves > 0 && config->repeticiones > 0 && config->aciertos <= 100;
+}
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static double ahora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// Generador congruencial simple: reproducible entre corridas.
+static size_t siguiente(size_t* estado)
+{
+    *estado = *estado * 6364136223846793005u + 1442695040888963407u;
+    return *estado >> 17;
+}
+
+// Uniforme en [0, 1), con los 47 bits de siguiente.
+static double siguiente_real(size_t* estado)
+{
+    return (double) siguiente(estado) / 140737488355328.0;
+}
+
+static size_t pico_rss_kb(void)
+{
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return (size_t) uso.ru_maxrss;
+}
+
+static int comparar_double(const void* a, const void* b)
+{
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+// Evita que el compilador descarte las operaciones.
+static volatile size_t sumidero;
+
+/* Claves: las 'claves' presentes y otras tantas ausentes, todas distintas.
+ * Cada una empieza con su indice en hexadecimal (8 digitos) y sigue con
+ * letras al azar hasta su largo. */
+typedef struct claves {
+    char* bytes;
+    const char** presentes;
+    const char** ausentes;
+} claves_t;
+
+static size_t largo_al_azar(largos_t largos, size_t* estado)
+{
+    switch (largos) {
+    case LARGOS_UNIFORME: return 8 + siguiente(estado) % 57;
+    case LARGOS_MEZCLA:
+        if (siguiente(estado) % 100 < 80) return 8 + siguiente(estado) % 8;
+        return 40 + siguiente(estado) % 61;
+    default: return 16;
+    }
+}
+
+static bool claves_crear(claves_t* claves, const config_t* config)
+{
+    // Los largos salen de su propio generador: se recorren dos veces, una
+    // para saber cuanta memoria pedir y otra para armar las claves.
+    size_t total = 2 * config->claves;
+    size_t estado_largos = config->semilla;
+    size_t bytes = 0;
+    for (size_t i = 0; i < total; i++) bytes += largo_al_azar(config->largos, &estado_largos) + 1;
+    claves->bytes = malloc(bytes);
+    claves->presentes = malloc(total * sizeof(char*));
+    if (!claves->bytes || !claves->presentes) {
+        free(claves->bytes);
+        free(claves->presentes);
+        return false;
+    }
+    claves->ausentes = claves->presentes + config->claves;
+    estado_largos = config->semilla;
+    size_t estado_letras = config->semilla + 1;
+    char* actual = claves->bytes;
+    for (size_t i = 0; i < total; i++) {
+        size_t largo = largo_al_azar(config->largos, &estado_largos);
+        for (size_t d = 0; d < 8; d++) actual[d] = "0123456789abcdef"[(i >> (28 - 4 * d)) & 0xF];
+        for (size_t j = 8; j < largo; j++) actual[j] = (char) ('a' + siguiente(&estado_letras) % 26);
+        actual[largo] = '\0';
+        claves->presentes[i] = actual;
+        actual += largo + 1;
+    }
+    return true;
+}
+
+static void claves_destruir(claves_t* claves)
+{
+    free(claves->bytes);
+    free(claves->presentes);
+}
+
+/* ******************************************************************
+ *                        CARGAS
+ * *****************************************************************/
+
+typedef struct carga {
+    const char* nombre;
+    operacion_t operacion;
+    bool llena;                 // la tabla empieza con todas las claves
+} carga_t;
+
+static const carga_t CARGAS[] = {
+    {"insercion", OPERACION_GUARDAR, false},
+    {"aciertos", OPERACION_OBTENER, true},
+    {"fallos", OPERACION_OBTENER, true},
+    {"mixta", OPERACION_OBTENER, true},
+    {"zipf", OPERACION_OBTENER, true},
+    {"rotacion", OPERACION_ROTAR, true},
+};
+
+/* Rango k de 0 a n-1 con probabilidad proporcional a 1/(k+1)^s: busqueda
+ * binaria en la distribucion acumulada. */
+static size_t zipf_rango(const double* acumulada, size_t n, double u)
+{
+    size_t inicio = 0, fin = n - 1;
+    while (inicio < fin) {
+        size_t medio = inicio + (fin - inicio) / 2;
+        if (acumulada[medio] < u) inicio = medio + 1;
+        else fin = medio;
+    }
+    return inicio;
+}
+
+/* Arma la secuencia de claves de la carga antes de medir, asi el costo de
+ * elegirlas no entra en la medicion. Devuelve su largo en *largo. */
+static const char** secuencia_crear(const carga_t* carga, const config_t* config,
+                                    const claves_t* claves, size_t* largo)
+{
+    size_t n = config->claves;
+    size_t estado = config->semilla * 7919 + 1;
+    *largo = carga->operacion == OPERACION_GUARDAR ? n : config->operaciones;
+    const char** secuencia = malloc((*largo + 1) * sizeof(char*));
+    if (!secuencia) return NULL;
+
+    if (strcmp(carga->nombre, "zipf") == 0) {
+        // Los rangos se asignan a claves al azar: las mas pedidas no son
+        // las primeras que se guardaron.
+        double* acumulada = malloc(n * sizeof(double));
+        size_t* permutacion = malloc(n * sizeof(size_t));
+        if (!acumulada || !permutacion) {
+            free(acumulada);
+            free(permutacion);
+            free(secuencia);
+            return NULL;
+        }
+        double suma = 0;
+        for (size_t k = 0; k < n; k++) {
+            suma += 1.0 / pow((double) (k + 1), config->zipf);
+            acumulada[k] = suma;
+            permutacion[k] = k;
+        }
+        for (size_t k = 0; k < n; k++) acumulada[k] /= suma;
+        for (size_t k = n - 1; k > 0; k--) {
+            size_t j = siguiente(&estado) % (k + 1);
+            size_t aux = permutacion[k];
+            permutacion[k] = permutacion[j];
+            permutacion[j] = aux;
+        }
+        for (size_t i = 0; i < *largo; i++) {
+            secuencia[i] = claves->presentes[permutacion[zipf_rango(acumulada, n, siguiente_real(&estado))]];
+        }
+        free(acumulada);
+        free(permutacion);
+        return secuencia;
+    }
+
+    unsigned aciertos = 100;
+    if (strcmp(carga->nombre, "fallos") == 0) aciertos = 0;
+    if (strcmp(carga->nombre, "mixta") == 0) aciertos = config->aciertos;
+    for (size_t i = 0; i < *largo; i++) {
+        if (carga->operacion == OPERACION_GUARDAR) {
+            secuencia[i] = claves->presentes[i];
+        } else if (carga->operacion == OPERACION_ROTAR && i % 2 == 1) {
+            // borra una clave y en la operacion siguiente la vuelve a guardar
+            secuencia[i] = secuencia[i - 1];
+        } else {
+            bool acierto = siguiente(&estado) % 100 < aciertos;
+            secuencia[i] = (acierto ? claves->presentes : claves->ausentes)[siguiente(&estado) % n];
+        }
+    }
+    return secuencia;
+}
+
+static hash_t* tabla_preparar(const carga_t* carga, const config_t* config, const claves_t* claves)
+{
+    hash_opciones_t opciones;
+    memset(&opciones, 0, sizeof(hash_opciones_t));
+    opciones.sondeo = config->sondeo;
+    opciones.incremental = config->incremental;
+    opciones.semilla = config->semilla;
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    if (hash && carga->llena) {
+        for (size_t i = 0; i < config->claves; i++) {
+            hash_guardar(hash, claves->presentes[i], (void*) claves->presentes[i]);
+        }
+    }
+    return hash;
+}
+
+static inline size_t operar(hash_t* hash, operacion_t operacion, const char* clave, size_t i)
+{
+    switch (operacion) {
+    case OPERACION_GUARDAR: return hash_guardar(hash, clave, (void*) clave);
+    case OPERACION_OBTENER: return hash_obtener(hash, clave) != NULL;
+    default:
+        if (i % 2 == 0) return hash_borrar(hash, clave) != NULL;
+        return hash_guardar(hash, clave, (void*) clave);
+    }
+}
+
+/* Corre la carga sobre una tabla nueva y devuelve los ns por operacion.
+ * Si latencias no es NULL mide ademas cada operacion por separado,
+ * descontando sobrecosto (lo que tarda leer el reloj). */
+static double correr(const carga_t* carga, const config_t* config, const claves_t* claves,
+                     const char** secuencia, size_t largo, double* latencias, double sobrecosto)
+{
+    hash_t* hash = tabla_preparar(carga, config, claves);
+    if (!hash) return -1;
+    size_t resultado = 0;
+    double inicio = ahora_ns();
+    if (latencias) {
+        for (size_t i = 0; i < largo; i++) {
+            double antes = ahora_ns();
+            resultado += operar(hash, carga->operacion, secuencia[i], i);
+            latencias[i] = ahora_ns() - antes - sobrecosto;
+        }
+    } else {
+        for (size_t i = 0; i < largo; i++) resultado += operar(hash, carga->operacion, secuencia[i], i);
+    }
+    double ns = (ahora_ns() - inicio) / (double) largo;
+    sumidero += resultado;
+    hash_destruir(hash);
+    return ns;
+}
+
+// El menor de muchos pares de lecturas seguidas del reloj.
+static double sobrecosto_reloj(void)
+{
+    double minimo = 1e9;
+    for (size_t i = 0; i < 10000; i++) {
+        double antes = ahora_ns();
+        double despues = ahora_ns();
+        if (despues - antes < minimo) minimo = despues - antes;
+    }
+    return minimo;
+}
+
+/* ******************************************************************
+ *                        RESULTADOS
+ * *****************************************************************/
+
+typedef struct resultado {
+    const char* carga;
+    size_t operaciones;
+    double ns_mediana;
+    double ns_min;
+    double ns_max;
+    double percentiles[PERCENTILES];
+    size_t pico_rss_kb;
+} resultado_t;
+
+static void imprimir_encabezado(const config_t* config)
+{
+    if (config->formato == FORMATO_TEXTO) {
+        printf("claves %zu, sondeo %s%s, largos %s, semilla %zu, %zu corridas (+%zu de calentamiento)\n\n",
+               config->claves, NOMBRES_SONDEO[config->sondeo], config->incremental ? " incremental" : "",
+               NOMBRES_LARGOS[config->largos], config->semilla, config->repeticiones, config->calentamiento);
+        printf("%-10s %11s %9s %9s %9s %8s %8s %8s %8s %10s %10s\n", "carga", "operaciones", "ns/op",
+               "ns/op min", "ns/op max", "p50", "p90", "p99", "p99.9", "max", "pico KB");
+    } else if (config->formato == FORMATO_CSV) {
+        printf("carga,sondeo,incremental,largos,claves,operaciones,repeticiones,semilla,"
+               "ns_op,ns_op_min,ns_op_max,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,pico_rss_kb\n");
+    } else {
+        printf("[");
+    }
+}
+
+static void imprimir_resultado(const config_t* config, const resultado_t* r, bool primero)
+{
+    const double* p = r->percentiles;
+    if (config->formato == FORMATO_TEXTO) {
+        printf("%-10s %11zu %9.1f %9.1f %9.1f %8.0f %8.0f %8.0f %8.0f %10.0f %10zu\n", r->carga,
+               r->operaciones, r->ns_mediana, r->ns_min, r->ns_max, p[0], p[1], p[2], p[3], p[4],
+               r->pico_rss_kb);
+    } else if (config->formato == FORMATO_CSV) {
+        printf("%s,%s,%d,%s,%zu,%zu,%zu,%zu,%.2f,%.2f,%.2f,%.0f,%.0f,%.0f,%.0f,%.0f,%zu\n", r->carga,
+               NOMBRES_SONDEO[config->sondeo], config->incremental, NOMBRES_LARGOS[config->largos],
+               config->claves, r->operaciones, config->repeticiones, config->semilla, r->ns_mediana,
+               r->ns_min, r->ns_max, p[0], p[1], p[2], p[3], p[4], r->pico_rss_kb);
+    } else {
+        printf("%s\n  {\"carga\": \"%s\", \"sondeo\": \"%s\", \"incremental\": %s, \"largos\": \"%s\", "
+               "\"claves\": %zu, \"operaciones\": %zu, \"repeticiones\": %zu, \"semilla\": %zu, "
+               "\"ns_op\": %.2f, \"ns_op_min\": %.2f, \"ns_op_max\": %.2f, \"p50_ns\": %.0f, "
+               "\"p90_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f, "
+               "\"pico_rss_kb\": %zu}",
+               primero ? "" : ",", r->carga, NOMBRES_SONDEO[config->sondeo],
+               config->incremental ? "true" : "false", NOMBRES_LARGOS[config->largos], config->claves,
+               r->operaciones, config->repeticiones, config->semilla, r->ns_mediana, r->ns_min,
+               r->ns_max, p[0], p[1], p[2], p[3], p[4], r->pico_rss_kb);
+    }
+}
+
+/* Calienta, mide las corridas y una corrida mas con latencias. Devuelve
+ * false si no hubo memoria. */
+static bool medir_carga(const carga_t* carga, const config_t* config, const claves_t* claves,
+                        double sobrecosto, resultado_t* resultado)
+{
+    size_t largo;
+    const char** secuencia = secuencia_crear(carga, config, claves, &largo);
+    double* tiempos = malloc(config->repeticiones * sizeof(double));
+    double* latencias = malloc((largo + 1) * sizeof(double));
+    bool ok = secuencia && tiempos && latencias && largo > 0;
+    for (size_t i = 0; ok && i < config->calentamiento; i++) {
+        ok = correr(carga, config, claves, secuencia, largo, NULL, 0) >= 0;
+    }
+    for (size_t i = 0; ok && i < config->repeticiones; i++) {
+        tiempos[i] = correr(carga, config, claves, secuencia, largo, NULL, 0);
+        ok = tiempos[i] >= 0;
+    }
+    ok = ok && correr(carga, config, claves, secuencia, largo, latencias, sobrecosto) >= 0;
+    if (ok) {
+        qsort(tiempos, config->repeticiones, sizeof(double), comparar_double);
+        qsort(latencias, largo, sizeof(double), comparar_double);
+        resultado->carga = carga->nombre;
+        resultado->operaciones = largo;
+        // Con una cantidad par de corridas, el promedio de las dos del medio
+        size_t medio = config->repeticiones / 2;
+        resultado->ns_mediana = config->repeticiones % 2 ? tiempos[medio] : (tiempos[medio - 1] + tiempos[medio]) / 2;
+        resultado->ns_min = tiempos[0];
+        resultado->ns_max = tiempos[config->repeticiones - 1];
+        for (size_t p = 0; p < PERCENTILES; p++) {
+            size_t i = (size_t) (PERCENTIL[p] * (double) (largo - 1));
+            resultado->percentiles[p] = latencias[i] > 0 ? latencias[i] : 0;
+        }
+        resultado->pico_rss_kb = pico_rss_kb();
+    }
+    free(latencias);
+    free(tiempos);
+    free(secuencia);
+    return ok;
+}
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+int main(int argc, char *argv[])
+{
+    config_t config;
+    bool valida = leer_config(argc, argv, &config);
+    if (valida && config.carga) {
+        valida = false;
+        for (size_t c = 0; c < sizeof(CARGAS) / sizeof(CARGAS[0]); c++) {
+            valida |= strcmp(config.carga, CARGAS[c].nombre) == 0;
+        }
+    }
+    if (!valida) {
+        fprintf(stderr, "Uso: %s [-n claves] [-o operaciones] [-r repeticiones] [-w calentamiento]\n"
+                        "       [-c insercion|aciertos|fallos|mixta|zipf|rotacion] [-a aciertos]\n"
+                        "       [-z zipf] [-l fijo|uniforme|mezcla] [-s lineal|grupos|robin_hood]\n"
+                        "       [-i] [-m semilla] [-f texto|csv|json]\n", argv[0]);
+        return 1;
+    }
+    claves_t claves;
+    if (!claves_crear(&claves, &config)) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", config.claves);
+        return 1;
+    }
+
+    double sobrecosto = sobrecosto_reloj();
+    bool primero = true;
+    int estado = 0;
+    imprimir_encabezado(&config);
+    for (size_t c = 0; c < sizeof(CARGAS) / sizeof(CARGAS[0]); c++) {
+        if (config.carga && strcmp(config.carga, CARGAS[c].nombre) != 0) continue;
+        resultado_t resultado;
+        if (!medir_carga(&CARGAS[c], &config, &claves, sobrecosto, &resultado)) {
+            fprintf(stderr, "No se pudo medir la carga %s\n", CARGAS[c].nombre);
+            estado = 1;
+            continue;
+        }
+        imprimir_resultado(&config, &resultado, primero);
+        primero = false;
+        fflush(stdout);
+    }
+    if (config.formato == FORMATO_JSON) printf("\n]\n");
+    claves_destruir(&claves);
+    return estado;
+}
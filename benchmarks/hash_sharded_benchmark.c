@@ -0,0 +1,195 @@
+/*
+ * hash_sharded_benchmark.c
+ * Escalabilidad del hash repartido en shards frente a un hash_t protegido
+ * por un unico mutex.
+ *
+ * Compilar desde la raiz del repositorio:
+ *     gcc -O2 -std=c99 -pthread -I. -o hash_sharded_benchmark hash.c \
+ *         hash_sharded.c benchmarks/hash_sharded_benchmark.c
+ * Uso:
+ *     ./hash_sharded_benchmark [hilos_max] [claves]
+ * Para 1, 2, 4, ... hasta hilos_max hilos (por defecto los procesadores
+ * disponibles) y para 100%, 90% y 50% de lecturas, mide millones de
+ * operaciones por segundo sobre una tabla con 'claves' claves (por
+ * defecto 10^6). Las escrituras alternan borrar y volver a guardar una
+ * clave al azar, asi la tabla mantiene su tamaño.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "hash.h"
+#include "hash_sharded.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LARGO_CLAVE 24
+#define OPERACIONES_POR_HILO 1000000
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static double ahora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// Generador congruencial simple: reproducible entre corridas.
+static size_t siguiente(size_t* estado)
+{
+    *estado = *estado * 6364136223846793005u + 1442695040888963407u;
+    return *estado >> 17;
+}
+
+/* Las dos tablas detras de la misma interfaz, para medir con el mismo
+ * ciclo. Se usa el hash_sharded_t si no es NULL. */
+typedef struct tabla {
+    hash_sharded_t* sharded;
+    hash_t* hash;
+    pthread_mutex_t mutex;
+} tabla_t;
+
+static void* tabla_obtener(tabla_t* tabla, const char* clave)
+{
+    if (tabla->sharded) return hash_sharded_obtener(tabla->sharded, clave);
+    pthread_mutex_lock(&tabla->mutex);
+    void* dato = hash_obtener(tabla->hash, clave);
+    pthread_mutex_unlock(&tabla->mutex);
+    return dato;
+}
+
+static void tabla_guardar(tabla_t* tabla, const char* clave, void* dato)
+{
+    if (tabla->sharded) {
+        hash_sharded_guardar(tabla->sharded, clave, dato);
+        return;
+    }
+    pthread_mutex_lock(&tabla->mutex);
+    hash_guardar(tabla->hash, clave, dato);
+    pthread_mutex_unlock(&tabla->mutex);
+}
+
+static void tabla_borrar(tabla_t* tabla, const char* clave)
+{
+    if (tabla->sharded) {
+        hash_sharded_borrar(tabla->sharded, clave);
+        return;
+    }
+    pthread_mutex_lock(&tabla->mutex);
+    hash_borrar(tabla->hash, clave);
+    pthread_mutex_unlock(&tabla->mutex);
+}
+
+typedef struct hilo {
+    pthread_t id;
+    tabla_t* tabla;
+    char (*claves)[LARGO_CLAVE];
+    size_t largo;
+    unsigned porcentaje_lecturas;
+    size_t semilla;
+    size_t encontrados;
+} hilo_t;
+
+static void* trabajar(void* extra)
+{
+    hilo_t* hilo = extra;
+    size_t estado = hilo->semilla;
+    bool borrar = true;
+    for (size_t i = 0; i < OPERACIONES_POR_HILO; i++) {
+        const char* clave = hilo->claves[siguiente(&estado) % hilo->largo];
+        if (siguiente(&estado) % 100 < hilo->porcentaje_lecturas) {
+            hilo->encontrados += tabla_obtener(hilo->tabla, clave) != NULL;
+        } else if (borrar) {
+            tabla_borrar(hilo->tabla, clave);
+            borrar = false;
+        } else {
+            tabla_guardar(hilo->tabla, clave, (void*) clave);
+            borrar = true;
+        }
+    }
+    return NULL;
+}
+
+/* ******************************************************************
+ *                        BENCHMARKS
+ * *****************************************************************/
+
+// Devuelve millones de operaciones por segundo.
+static double medir(tabla_t* tabla, char (*claves)[LARGO_CLAVE], size_t largo,
+                    size_t hilos, unsigned porcentaje_lecturas)
+{
+    hilo_t* trabajos = calloc(hilos, sizeof(hilo_t));
+    for (size_t i = 0; i < largo; i++) tabla_guardar(tabla, claves[i], claves[i]);
+
+    double inicio = ahora_ns();
+    for (size_t i = 0; i < hilos; i++) {
+        trabajos[i].tabla = tabla;
+        trabajos[i].claves = claves;
+        trabajos[i].largo = largo;
+        trabajos[i].porcentaje_lecturas = porcentaje_lecturas;
+        trabajos[i].semilla = i + 1;
+        pthread_create(&trabajos[i].id, NULL, trabajar, &trabajos[i]);
+    }
+    for (size_t i = 0; i < hilos; i++) pthread_join(trabajos[i].id, NULL);
+    double segundos = (ahora_ns() - inicio) / 1e9;
+
+    free(trabajos);
+    return (double) (hilos * OPERACIONES_POR_HILO) / segundos / 1e6;
+}
+
+static void benchmark_escalabilidad(char (*claves)[LARGO_CLAVE], size_t largo,
+                                    size_t hilos, unsigned porcentaje_lecturas)
+{
+    tabla_t sharded, con_mutex;
+    memset(&sharded, 0, sizeof(tabla_t));
+    memset(&con_mutex, 0, sizeof(tabla_t));
+    sharded.sharded = hash_sharded_crear(0, NULL, NULL);
+    con_mutex.hash = hash_crear(NULL);
+    pthread_mutex_init(&con_mutex.mutex, NULL);
+
+    double mops_sharded = medir(&sharded, claves, largo, hilos, porcentaje_lecturas);
+    double mops_mutex = medir(&con_mutex, claves, largo, hilos, porcentaje_lecturas);
+    printf("%10zu %10u%% %14.2f %14.2f\n", hilos, porcentaje_lecturas, mops_sharded, mops_mutex);
+
+    pthread_mutex_destroy(&con_mutex.mutex);
+    hash_destruir(con_mutex.hash);
+    hash_sharded_destruir(sharded.sharded);
+}
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+int main(int argc, char *argv[])
+{
+    long hilos_max = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t largo = 1000000;
+    if (argc > 1) hilos_max = strtol(argv[1], NULL, 10);
+    if (argc > 2) largo = (size_t) strtol(argv[2], NULL, 10);
+    if (hilos_max < 1) hilos_max = 1;
+
+    char (*claves)[LARGO_CLAVE] = malloc(largo * LARGO_CLAVE);
+    if (!claves) {
+        fprintf(stderr, "Sin memoria para %zu claves\n", largo);
+        return 1;
+    }
+    for (size_t i = 0; i < largo; i++) snprintf(claves[i], LARGO_CLAVE, "c%010zu", i);
+
+    unsigned lecturas[] = {100, 90, 50};
+    printf("%10s %11s %14s %14s\n", "hilos", "lecturas", "Mops/s shards", "Mops/s mutex");
+    for (size_t l = 0; l < sizeof(lecturas) / sizeof(lecturas[0]); l++) {
+        for (size_t hilos = 1; hilos <= (size_t) hilos_max; hilos *= 2) {
+            benchmark_escalabilidad(claves, largo, hilos, lecturas[l]);
+        }
+    }
+    free(claves);
+    return 0;
+}
@@ -2,230 +2,1702 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "hash.h"
+#include "hash_interno.h"
+#include "hash_arena.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAY_AVX2 1
+#endif
 
 
 #define OCUPADO 1
 #define BORRADO 2
 #define VACIO 0
 #define NO_OCUPADO 3
-#define TAM_INICIAL 31
-#define CARGA_MAX 0.7
-#define CARGA_MIN 0.3
+// Marca temporal de hash_recompactar: clave que falta reubicar.
+#define PENDIENTE 4
+#define NO_ENCONTRADO ((size_t)-1)
+// Bytes de control del sondeo por grupos. Una clave ocupada guarda los 7
+// bits bajos de su hash; VACIO y BORRADO tienen el bit alto encendido.
+#define CONTROL_VACIO 0x80
+#define CONTROL_BORRADO 0xFE
+#define CONTROL_ETIQUETA(h) ((uint8_t)((h) & 0x7F))
+// Ancho maximo de ventana (AVX2). Al final del arreglo de control se
+// repiten los primeros GRUPO_MAX-1 bytes para leer ventanas sin cortar.
+#define GRUPO_MAX 32
+// Posiciones de la tabla vieja que cada guardar o borrar migra a la nueva
+// en el redimensionado incremental.
+#ifndef MIGRACION_PASO
+#define MIGRACION_PASO 32
+#endif
+// Claves que las busquedas en lote resuelven juntas: los campos de todas
+// se piden a memoria antes de comparar la primera.
+#define LOTE_BLOQUE 16
+// Las operaciones masivas se reparten entre hilos desde esta capacidad, en
+// a lo sumo HILOS_MAX tramos. Cada hilo guarda aparte hasta DESBORDE_MAX
+// campos que no entran en su tramo.
+#ifndef PARALELO_MIN
+#define PARALELO_MIN (1 << 16)
+#endif
+#define HILOS_MAX 64
+#ifndef DESBORDE_MAX
+#define DESBORDE_MAX 256
+#endif
+// Hash congelado: elementos por cubeta de la funcion perfecta, en promedio,
+// y maximo en una cubeta (con mas se considera que la funcion de hash no
+// reparte y no se congela).
+#define CONGELADO_CUBETA 2
+#define CONGELADO_CUBETA_MAX 64
+// Con -DHASH_ESTADISTICAS las busquedas cuentan aciertos y fallos. Se
+// cuentan de forma atomica: varios hilos pueden leer el mismo hash a la vez.
+#ifdef HASH_ESTADISTICAS
+#if defined(__GNUC__)
+#define CONTAR(hash, contador) __atomic_fetch_add(&((hash_t*)(hash))->contador, 1, __ATOMIC_RELAXED)
+#define LEER_CONTADOR(hash, contador) __atomic_load_n(&(hash)->contador, __ATOMIC_RELAXED)
+#else
+#define CONTAR(hash, contador) (((hash_t*)(hash))->contador++)
+#define LEER_CONTADOR(hash, contador) ((hash)->contador)
+#endif
+#else
+#define CONTAR(hash, contador) ((void)0)
+#endif
+#if defined(__GNUC__)
+#define PRECARGAR(p) __builtin_prefetch(p)
+#else
+#define PRECARGAR(p) ((void)(p))
+#endif
 /* ******************************************************************
  *                           STRUCTS
  * *****************************************************************/
+// Clave de mas de HASH_CLAVE_CORTA bytes: un solo bloque con el largo adelante.
+typedef struct clave_larga{
+  size_t largo;
+  char bytes[];       // largo bytes mas un '\0'
+}clave_larga_t;
+
 typedef struct campo{
-  char* clave;
+  uint64_t hash;      // hash completo de la clave, se compara antes que la clave
+  union{
+    char corta[HASH_CLAVE_CORTA + 1];
+    clave_larga_t* larga;
+  }clave;
   void* valor;
-  size_t estado;
+  uint32_t largo;     // largo de la clave en bytes
+  uint32_t estado;
+  uint32_t distancia; // en Robin Hood: posiciones desde la inicial
 }campo_t;
 
 struct hash{
-  size_t capacidad;
+  hash_allocator_t allocator;
+  size_t capacidad;     // siempre potencia de dos
+  size_t mascara;       // capacidad - 1
+  unsigned desplazamiento; // 64 - log2(capacidad)
   size_t cantidad;
+  size_t borrados;      // campos BORRADO de la tabla actual
+  size_t reservada;     // capacidad por debajo de la cual no se achica
   hash_destruir_dato_t funcion_destruccion;
+  hash_sondeo_t sondeo;
+  hash_funcion_hash_t funcion_hash;
+  uint64_t semilla;
   campo_t* campos;
+  uint8_t* control; // solo en HASH_SONDEO_GRUPOS, capacidad + GRUPO_MAX-1 bytes
+  arena_t arena;    // claves largas
+  bool incremental;
+  campo_t* campos_viejos;  // tabla que se esta migrando, o NULL
+  size_t capacidad_vieja;  // 0 si no hay migracion
+  unsigned desplazamiento_viejo;
+  size_t migrado;          // posiciones de campos_viejos ya recorridas
+  size_t hilos;            // para operaciones masivas
+  bool destruir_en_paralelo;
+  size_t (*grupos_ubicar)(const struct hash* hash, const char* clave, size_t largo, uint64_t h, bool* encontrado);
+  bool congelado;          // campos tiene exactamente cantidad posiciones
+  uint32_t* pilotos;       // uno por cubeta de la funcion perfecta
+  size_t cantidad_pilotos;
+  size_t redimensiones;
+  size_t recompactaciones;
+#ifdef HASH_ESTADISTICAS
+  uint64_t aciertos;
+  uint64_t fallos;
+#endif
 };
 
 struct hash_iter{
   const hash_t* hash;
-  campo_t campo_act;
   size_t posicion;
+  size_t fin;         // el iterador recorre [posicion inicial, fin)
 };
 
 /* ******************************************************************
  *                      FUNCIONES AUXILIARES
  * *****************************************************************/
 
+/* Toda la memoria del hash se pide y se devuelve por su allocator. */
+
+static void* hash_pedir(const hash_t* hash, size_t tam){
+  return hash->allocator.pedir(hash->allocator.contexto, tam);
+}
+
+static void hash_liberar(const hash_t* hash, void* ptr, size_t tam){
+  if (ptr != NULL) hash->allocator.liberar(hash->allocator.contexto, ptr, tam);
+}
+
+
+
+/* Funcion de hash original: polinomio 31*h + c byte a byte. Se conserva
+ * como HASH_FUNCION_CLASICA; ignora la semilla.
+ */
+uint64_t fhash(const void *clave, size_t largo, uint64_t semilla){
+    const char* s = clave;
+    uint64_t hashval = 0;
+    (void)semilla;
+
+    for (size_t i = 0; i < largo; i++)
+        hashval = (uint64_t)(size_t)s[i] + 31*hashval;
+    return hashval;
+}
+
+/* Multiplica a*b en 128 bits y deja la parte baja en *a y la alta en *b. */
+static inline void mum(uint64_t* a, uint64_t* b){
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = (__uint128_t)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t mezclar(uint64_t a, uint64_t b){
+  mum(&a, &b);
+  return a ^ b;
+}
 
+static inline uint64_t leer64(const uint8_t* p){
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t leer32(const uint8_t* p){
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
 
-char* strdup (const char* s) {
-	char* dup = malloc(strlen (s)+1);
-	if (dup == NULL)
-		return NULL;
-  strcpy(dup,s);
-	return dup;
+#define WY_P0 0xa0761d6478bd642full
+#define WY_P1 0xe7037ed1a0b428dbull
+#define WY_P2 0x8ebc6af09c88c6e3ull
+#define WY_P3 0x589965cc75374cc3ull
+
+/* Funcion de hash rapida (HASH_FUNCION_RAPIDA), del estilo de wyhash: lee
+ * la clave de a 8 bytes y mezcla con multiplicaciones de 64x64->128 bits.
+ * Las claves de hasta 16 bytes se resuelven con dos lecturas solapadas.
+ */
+uint64_t fhash_rapida(const void *clave, size_t largo, uint64_t semilla){
+  const uint8_t* p = clave;
+  uint64_t a, b;
+  semilla ^= mezclar(semilla ^ WY_P0, WY_P1);
+  if (largo <= 16){
+    if (largo >= 4){
+      size_t medio = (largo >> 3) << 2;
+      a = (leer32(p) << 32) | leer32(p + medio);
+      b = (leer32(p + largo - 4) << 32) | leer32(p + largo - 4 - medio);
+    } else if (largo > 0){
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[largo >> 1] << 8) | p[largo - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t resto = largo;
+    if (resto > 48){
+      uint64_t s1 = semilla, s2 = semilla;
+      do {
+        semilla = mezclar(leer64(p) ^ WY_P1, leer64(p + 8) ^ semilla);
+        s1 = mezclar(leer64(p + 16) ^ WY_P2, leer64(p + 24) ^ s1);
+        s2 = mezclar(leer64(p + 32) ^ WY_P3, leer64(p + 40) ^ s2);
+        p += 48;
+        resto -= 48;
+      } while (resto > 48);
+      semilla ^= s1 ^ s2;
+    }
+    while (resto > 16){
+      semilla = mezclar(leer64(p) ^ WY_P1, leer64(p + 8) ^ semilla);
+      p += 16;
+      resto -= 16;
+    }
+    a = leer64(p + resto - 16);
+    b = leer64(p + resto - 8);
+  }
+  a ^= WY_P1;
+  b ^= semilla;
+  mum(&a, &b);
+  return mezclar(a ^ WY_P0 ^ largo, b ^ WY_P1);
 }
 
-size_t fhash(const char *s, size_t tam){
-    size_t hashval;
+// Tablas creadas desde el arranque, para hash_semilla_aleatoria.
+uint64_t hash_semillas_creadas = 0;
 
-    for (hashval = 0; *s != '\0'; s++)
-        hashval = (size_t)*s + 31*hashval;
-    return hashval % tam;
+static uint64_t hash_calcular(const hash_t* hash, const char* clave, size_t largo){
+  return hash->funcion_hash(clave, largo, hash->semilla);
 }
 
-campo_t crear_campo(char* clave, void* dato, size_t estado){
+uint64_t hash_hash_clave(const hash_t *hash, const char *clave, size_t largo){
+  return hash_calcular(hash, clave, largo);
+}
+
+/* Posicion inicial del sondeo para el hash h: toma los bits altos de h
+ * multiplicado por HASH_FIBONACCI, sin dividir.
+ */
+static size_t posicion_de(const hash_t* hash, uint64_t h){
+  return (size_t)((h * HASH_FIBONACCI) >> hash->desplazamiento);
+}
+
+
+/* Capacidad por debajo de la cual no se achica el hash: la inicial o la
+ * reservada. En el sondeo por grupos tiene que entrar al menos una ventana
+ * completa.
+ */
+static size_t capacidad_minima(const hash_t* hash){
+  size_t minima = hash_capacidad_inicial();
+  if (hash->sondeo == HASH_SONDEO_GRUPOS && minima < GRUPO_MAX) minima = GRUPO_MAX;
+  return minima > hash->reservada ? minima : hash->reservada;
+}
+
+/* Pre: tam es potencia de dos. */
+static void hash_fijar_capacidad(hash_t* hash, size_t tam){
+  unsigned bits = 0;
+  while (((size_t)1 << bits) < tam) bits++;
+  hash->capacidad = tam;
+  hash->mascara = tam - 1;
+  hash->desplazamiento = 64 - bits;
+}
+
+static size_t clave_larga_tam(size_t largo){
+  return sizeof(clave_larga_t) + largo + 1;
+}
+
+/* Crea un campo sin clave; la clave se agrega con campo_copiar_clave. */
+static campo_t crear_campo(void* dato, uint64_t h, uint32_t estado){
   campo_t campo;
+  campo.hash = h;
   campo.estado = estado;
-  campo.clave = clave;
+  campo.distancia = 0;
+  campo.largo = 0;
+  campo.clave.corta[0] = '\0';
   campo.valor = dato;
   return campo;
 }
 
+/* Copia clave en el campo: dentro del campo si es corta, en la arena con
+ * su largo adelante si no. Devuelve false si no pudo pedir memoria.
+ */
+static bool campo_copiar_clave(arena_t* arena, campo_t* campo, const char* clave, size_t largo){
+  if (largo > UINT32_MAX) return false;
+  campo->largo = (uint32_t)largo;
+  char* destino = campo->clave.corta;
+  if (largo > HASH_CLAVE_CORTA){
+    campo->clave.larga = arena_pedir(arena, clave_larga_tam(largo));
+    if (campo->clave.larga == NULL) return false;
+    campo->clave.larga->largo = largo;
+    destino = campo->clave.larga->bytes;
+  }
+  memcpy(destino, clave, largo);
+  destino[largo] = '\0';
+  return true;
+}
+
+static void campo_liberar_clave(arena_t* arena, campo_t* campo){
+  if (campo->largo > HASH_CLAVE_CORTA) arena_devolver(arena, clave_larga_tam(campo->largo));
+}
 
+static const char* campo_clave(const campo_t* campo){
+  return campo->largo > HASH_CLAVE_CORTA ? campo->clave.larga->bytes : campo->clave.corta;
+}
 
+/* Compara primero el hash y el largo, que estan en el campo; solo si
+ * coinciden lee los bytes de la clave.
+ */
+static inline bool campo_clave_igual(const campo_t* campo, uint64_t h, const char* clave, size_t largo){
+  if (campo->hash != h || campo->largo != largo) return false;
+  return memcmp(campo_clave(campo), clave, largo) == 0;
+}
 
+/* Pide un arreglo de tam campos VACIO. */
+static campo_t* campos_crear(const hash_t* hash, size_t tam){
+  campo_t* campos = hash_pedir(hash, tam * sizeof(campo_t));
+  if (campos == NULL) return NULL;
+  for (size_t i=0;i<tam; i++){
+    campos[i] = crear_campo(NULL, 0, VACIO);
+  }
+  return campos;
+}
 
-size_t hash_buscar(const hash_t* hash,const char* clave){
-  size_t indice = fhash(clave, hash->capacidad);
-  size_t pos_act = 0;
-  for (size_t i=0; i<hash->capacidad; i++){
-    pos_act = (indice+i)%hash->capacidad;
-    if (hash->campos[pos_act].estado == OCUPADO){
-      if (strcmp(hash->campos[pos_act].clave,clave)==0) return pos_act;
+
+
+
+
+/* En modo Robin Hood cada campo guarda a que distancia quedo de su
+ * posicion inicial. Al insertar, una clave desplaza a la que encuentra mas
+ * cerca de su inicio ("le roba al rico"), asi los sondeos quedan parejos.
+ * No hay BORRADO: al borrar se corren hacia atras las claves siguientes.
+ */
+
+/* Busca clave cortando el sondeo en el primer VACIO o en el primer campo
+ * que este mas cerca de su inicio que la clave buscada: de haber estado,
+ * la clave lo hubiera desplazado. Si no la encuentra devuelve la posicion
+ * donde corto.
+ */
+static size_t robin_hood_ubicar(const hash_t* hash, const char* clave, size_t largo, uint64_t h, bool* encontrado){
+  size_t pos_act = posicion_de(hash, h);
+  *encontrado = false;
+  for (size_t distancia=0; distancia<hash->capacidad; distancia++){
+    const campo_t* campo = &hash->campos[pos_act];
+    if (campo->estado == VACIO || campo->distancia < distancia) return pos_act;
+    if (campo_clave_igual(campo, h, clave, largo)){
+      *encontrado = true;
+      return pos_act;
     }
+    pos_act = (pos_act + 1) & hash->mascara;
+  }
+  return NO_ENCONTRADO;
+}
+
+/* Inserta campo desplazando a las claves mas cercanas a su inicio y
+ * devuelve la posicion en la que quedo campo.
+ * Pre: la clave de campo no pertenece al hash y hay al menos un VACIO.
+ */
+static size_t robin_hood_insertar(hash_t* hash, campo_t campo){
+  size_t pos_act = posicion_de(hash, campo.hash);
+  size_t pos_nuevo = NO_ENCONTRADO;
+  campo.distancia = 0;
+  while (hash->campos[pos_act].estado == OCUPADO){
+    campo_t* actual = &hash->campos[pos_act];
+    if (actual->distancia < campo.distancia){
+      campo_t desplazado = *actual;
+      *actual = campo;
+      if (pos_nuevo == NO_ENCONTRADO) pos_nuevo = pos_act;
+      campo = desplazado;
+    }
+    campo.distancia++;
+    pos_act = (pos_act + 1) & hash->mascara;
+  }
+  hash->campos[pos_act] = campo;
+  return pos_nuevo == NO_ENCONTRADO ? pos_act : pos_nuevo;
+}
+
+/* Borra el campo de pos corriendo una posicion hacia atras a las claves
+ * siguientes, hasta un VACIO o una clave que ya esta en su inicio.
+ */
+static void robin_hood_borrar(hash_t* hash, size_t pos){
+  size_t sig = (pos + 1) & hash->mascara;
+  while (hash->campos[sig].estado == OCUPADO && hash->campos[sig].distancia > 0){
+    hash->campos[pos] = hash->campos[sig];
+    hash->campos[pos].distancia--;
+    pos = sig;
+    sig = (sig + 1) & hash->mascara;
+  }
+  hash->campos[pos] = crear_campo(NULL, 0, VACIO);
+}
+
+/* En el sondeo por grupos las posiciones son las mismas que en el lineal,
+ * pero el recorrido lee el arreglo de control en ventanas de 16 (SSE2) o
+ * 32 (AVX2) bytes y compara la etiqueta de 7 bits de todas a la vez. Solo
+ * se lee el campo (y se compara la clave) cuando la etiqueta coincide. Los
+ * campos mantienen su estado para iterar y redimensionar como siempre.
+ */
+
+static void control_fijar(hash_t* hash, size_t pos, uint8_t valor){
+  hash->control[pos] = valor;
+  if (pos < GRUPO_MAX - 1) hash->control[hash->capacidad + pos] = valor;
+}
+
+static size_t control_tam(size_t capacidad){
+  return capacidad + GRUPO_MAX - 1;
+}
+
+static uint8_t* control_crear(const hash_t* hash, size_t tam){
+  uint8_t* control = hash_pedir(hash, control_tam(tam));
+  if (control == NULL) return NULL;
+  memset(control, CONTROL_VACIO, tam + GRUPO_MAX - 1);
+  return control;
+}
+
+static inline unsigned primer_bit64(uint64_t mascara){
+#if defined(__GNUC__)
+  return (unsigned)__builtin_ctzll(mascara);
+#else
+  unsigned i = 0;
+  while (!(mascara & 1)){
+    mascara >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
 
+static inline unsigned primer_bit(uint32_t mascara){
+#if defined(__GNUC__)
+  return (unsigned)__builtin_ctz(mascara);
+#else
+  unsigned i = 0;
+  while (!(mascara & 1)){
+    mascara >>= 1;
+    i++;
   }
-  return 0;
+  return i;
+#endif
+}
+
+#if defined(__SSE2__)
+static inline uint32_t grupo16_iguales(const uint8_t* grupo, uint8_t valor){
+  __m128i g = _mm_loadu_si128((const __m128i*)grupo);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)valor)));
+}
+
+static inline uint32_t grupo16_libres(const uint8_t* grupo){
+  return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)grupo));
+}
+#else
+static inline uint32_t grupo16_iguales(const uint8_t* grupo, uint8_t valor){
+  uint32_t mascara = 0;
+  for (unsigned i=0; i<16; i++) mascara |= (uint32_t)(grupo[i] == valor) << i;
+  return mascara;
+}
+
+static inline uint32_t grupo16_libres(const uint8_t* grupo){
+  uint32_t mascara = 0;
+  for (unsigned i=0; i<16; i++) mascara |= (uint32_t)(grupo[i] >> 7) << i;
+  return mascara;
 }
+#endif
+
+#ifdef HAY_AVX2
+__attribute__((target("avx2")))
+static inline uint32_t grupo32_iguales(const uint8_t* grupo, uint8_t valor){
+  __m256i g = _mm256_loadu_si256((const __m256i*)grupo);
+  return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(g, _mm256_set1_epi8((char)valor)));
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t grupo32_libres(const uint8_t* grupo){
+  return (uint32_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)grupo));
+}
+#endif
+
+/* Define la busqueda por grupos para un ancho de ventana; se instancia una
+ * vez por juego de instrucciones para que las comparaciones se inlineen.
+ * Devuelve lo mismo que hash_ubicar.
+ */
+#define DEFINIR_GRUPOS_UBICAR(nombre, atributos, ancho, iguales, libres) \
+atributos static size_t nombre(const hash_t* hash, const char* clave, size_t largo, uint64_t h, bool* encontrado){ \
+  uint8_t etiqueta = CONTROL_ETIQUETA(h); \
+  size_t pos = posicion_de(hash, h); \
+  size_t pos_libre = NO_ENCONTRADO; \
+  *encontrado = false; \
+  for (size_t recorrido=0; recorrido<hash->capacidad; recorrido += (ancho)){ \
+    const uint8_t* grupo = hash->control + pos; \
+    uint32_t coincide = iguales(grupo, etiqueta); \
+    while (coincide){ \
+      size_t pos_act = (pos + primer_bit(coincide)) & hash->mascara; \
+      if (campo_clave_igual(&hash->campos[pos_act], h, clave, largo)){ \
+        *encontrado = true; \
+        return pos_act; \
+      } \
+      coincide &= coincide - 1; \
+    } \
+    uint32_t libre = libres(grupo); \
+    if (libre && pos_libre == NO_ENCONTRADO) pos_libre = (pos + primer_bit(libre)) & hash->mascara; \
+    if (iguales(grupo, CONTROL_VACIO)) return pos_libre; \
+    pos = (pos + (ancho)) & hash->mascara; \
+  } \
+  return pos_libre; \
+}
+
+DEFINIR_GRUPOS_UBICAR(grupos_ubicar_16, , 16, grupo16_iguales, grupo16_libres)
+#ifdef HAY_AVX2
+DEFINIR_GRUPOS_UBICAR(grupos_ubicar_32, __attribute__((target("avx2"))), 32, grupo32_iguales, grupo32_libres)
+#endif
+
+/* Elige en tiempo de ejecucion el ancho de ventana que soporta el
+ * procesador.
+ */
+static void grupos_elegir(hash_t* hash){
+  hash->grupos_ubicar = grupos_ubicar_16;
+#ifdef HAY_AVX2
+  if (__builtin_cpu_supports("avx2")) hash->grupos_ubicar = grupos_ubicar_32;
+#endif
+}
+
+/* Recorre una sola vez el sondeo de clave, cuyo hash es h, comparando
+ * primero el hash guardado en cada campo y solo si coincide la clave.
+ * Si la encuentra devuelve su
+ * posicion y deja *encontrado en true. Si no, devuelve donde corresponde
+ * insertarla: el primer BORRADO del camino o el VACIO que lo termino.
+ * El sondeo termina en el primer campo VACIO: los BORRADO se saltean
+ * porque la clave buscada pudo haberse guardado despues de ellos.
+ */
+HASH_DEFINIR_UBICAR_LINEAL(lineal_ubicar, hash_t, campo_t, campos, VACIO, BORRADO, campo_clave_igual)
 
-size_t hash_buscar_sig(hash_t* hash,const char* clave){
-  size_t indice = fhash(clave, hash->capacidad);
-  size_t pos_act = 0;
+static size_t hash_ubicar(const hash_t* hash, const char* clave, size_t largo, uint64_t h, bool* encontrado){
+  if (hash->sondeo == HASH_SONDEO_ROBIN_HOOD) return robin_hood_ubicar(hash, clave, largo, h, encontrado);
+  if (hash->sondeo == HASH_SONDEO_GRUPOS) return hash->grupos_ubicar(hash, clave, largo, h, encontrado);
+  return lineal_ubicar(hash, clave, largo, h, encontrado);
+}
+
+/* Devuelve la primera posicion libre (VACIO o BORRADO) del sondeo del
+ * hash h.
+ * Pre: la clave de hash h no pertenece al hash.
+ */
+static size_t hash_buscar_sig(const hash_t* hash, uint64_t h){
+  size_t pos_act = posicion_de(hash, h);
   for (size_t i=0; i<hash->capacidad; i++){
-    pos_act = (indice+i)%hash->capacidad;
-    if (hash->campos[pos_act].estado != OCUPADO){
-      return pos_act;
-    }
+    if (hash->campos[pos_act].estado != OCUPADO) return pos_act;
+    pos_act = (pos_act + 1) & hash->mascara;
+  }
+  return NO_ENCONTRADO;
+}
+
+/* Ubica un campo ya existente en la tabla actual sin duplicar la clave
+ * y devuelve su posicion. Las claves son unicas, asi que no hace falta
+ * buscarla antes, y con el hash guardado en el campo tampoco hace falta
+ * leerla.
+ */
+static inline size_t campo_reinsertar(hash_t* hash, campo_t campo){
+  if (hash->sondeo == HASH_SONDEO_ROBIN_HOOD){
+    return robin_hood_insertar(hash, campo);
+  }
+  if (hash->sondeo == HASH_SONDEO_GRUPOS){
+    size_t pos = posicion_de(hash, campo.hash);
+    while (hash->control[pos] < CONTROL_VACIO) pos = (pos + 1) & hash->mascara;
+    if (hash->campos[pos].estado == BORRADO) hash->borrados--;
+    control_fijar(hash, pos, CONTROL_ETIQUETA(campo.hash));
+    hash->campos[pos] = campo;
+    return pos;
+  }
+  size_t pos = hash_buscar_sig(hash, campo.hash);
+  if (hash->campos[pos].estado == BORRADO) hash->borrados--;
+  hash->campos[pos] = campo;
+  return pos;
+}
+
+/* Durante el redimensionado incremental la tabla vieja solo se lee y se
+ * marcan BORRADO sus campos, tanto los que se borran como los que ya se
+ * migraron; asi, en cualquier modo de sondeo, se la puede recorrer como
+ * sondeo lineal hasta el primer VACIO. Las claves nuevas van siempre a la
+ * tabla nueva, y una clave nunca esta en las dos.
+ */
+
+/* Devuelve el campo de clave en la tabla vieja, o NULL si no esta. */
+static campo_t* viejos_buscar(const hash_t* hash, const char* clave, size_t largo, uint64_t h){
+  size_t mascara = hash->capacidad_vieja - 1;
+  size_t pos_act = (size_t)((h * HASH_FIBONACCI) >> hash->desplazamiento_viejo);
+  for (size_t i=0; i<hash->capacidad_vieja; i++){
+    campo_t* campo = &hash->campos_viejos[pos_act];
+    if (campo->estado == VACIO) return NULL;
+    if (campo->estado == OCUPADO && campo_clave_igual(campo, h, clave, largo)) return campo;
+    pos_act = (pos_act + 1) & mascara;
+  }
+  return NULL;
+}
+
+/* Saca campo de la tabla vieja y lo pasa a la nueva. Devuelve su posicion
+ * en la nueva.
+ */
+static size_t viejo_migrar(hash_t* hash, campo_t* campo){
+  size_t pos = campo_reinsertar(hash, *campo);
+  campo->estado = BORRADO;
+  return pos;
+}
+
+/* Migra hasta pasos posiciones de la tabla vieja y, si termino de
+ * recorrerla, la libera.
+ */
+static void hash_migrar(hash_t* hash, size_t pasos){
+  if (hash->campos_viejos == NULL) return;
+  for (; pasos > 0 && hash->migrado < hash->capacidad_vieja; pasos--){
+    campo_t* campo = &hash->campos_viejos[hash->migrado++];
+    if (campo->estado == OCUPADO) viejo_migrar(hash, campo);
+  }
+  if (hash->migrado < hash->capacidad_vieja) return;
+  hash_liberar(hash, hash->campos_viejos, hash->capacidad_vieja * sizeof(campo_t));
+  hash->campos_viejos = NULL;
+  hash->capacidad_vieja = 0;
+}
 
+/* Hash congelado: cada clave cae en una cubeta, y el piloto de la cubeta
+ * elige su posicion. Al congelar se busca para cada cubeta un piloto con
+ * el que sus claves caen en posiciones todavia libres, asi la funcion es
+ * perfecta (sin colisiones) y minima (sin posiciones vacias). Los rangos
+ * se reducen multiplicando 32 bits del hash mezclado, sin dividir.
+ */
+static inline size_t reducir32(uint64_t x, size_t n){
+  return (size_t)(((x & 0xFFFFFFFFull) * (uint64_t)n) >> 32);
+}
+
+static inline size_t congelado_cubeta(uint64_t h, size_t cubetas){
+  return reducir32(mezclar(h, WY_P1) >> 32, cubetas);
+}
+
+static inline size_t congelado_posicion(uint64_t h, uint32_t piloto, size_t n){
+  return reducir32(mezclar(h ^ ((uint64_t)piloto * WY_P3), WY_P2), n);
+}
+
+static inline campo_t* congelado_campo(const hash_t* hash, uint64_t h){
+  uint32_t piloto = hash->pilotos[congelado_cubeta(h, hash->cantidad_pilotos)];
+  return &hash->campos[congelado_posicion(h, piloto, hash->capacidad)];
+}
+
+/* Busca clave en la tabla actual y, si hay una migracion en curso, en la
+ * vieja. Devuelve su campo o NULL.
+ */
+static inline campo_t* buscar_campo_h(const hash_t* hash, const char* clave, size_t largo, uint64_t h){
+  if (hash->congelado){
+    if (hash->capacidad == 0) return NULL;
+    campo_t* campo = congelado_campo(hash, h);
+    return campo_clave_igual(campo, h, clave, largo) ? campo : NULL;
   }
-  return 0;
+  bool encontrado;
+  size_t pos = hash_ubicar(hash, clave, largo, h, &encontrado);
+  if (encontrado) return &hash->campos[pos];
+  if (hash->campos_viejos != NULL) return viejos_buscar(hash, clave, largo, h);
+  return NULL;
 }
 
+static campo_t* hash_buscar_campo_h(const hash_t* hash, const char* clave, size_t largo, uint64_t h){
+  campo_t* campo = buscar_campo_h(hash, clave, largo, h);
+  if (campo != NULL) CONTAR(hash, aciertos);
+  else CONTAR(hash, fallos);
+  return campo;
+}
 
+static campo_t* hash_buscar_campo(const hash_t* hash, const char* clave, size_t largo){
+  return hash_buscar_campo_h(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+/* Busca hasta LOTE_BLOQUE claves en tres pasadas: calcula los hashes y
+ * precarga el campo inicial de cada una (y su control); con esos campos
+ * ya en camino precarga la clave larga del que coincide en hash; por
+ * ultimo resuelve cada busqueda como siempre. Deja en encontrados[i] el
+ * campo de claves[i] o NULL.
+ */
+static void hash_buscar_bloque(const hash_t* hash, const char** claves, size_t n, campo_t** encontrados){
+  uint64_t hashes[LOTE_BLOQUE];
+  size_t largos[LOTE_BLOQUE];
+  for (size_t i=0; i<n; i++){
+    largos[i] = strlen(claves[i]);
+    hashes[i] = hash_calcular(hash, claves[i], largos[i]);
+    // Congelado, el campo de su posicion es el unico que se lee
+    if (hash->congelado){
+      if (hash->capacidad > 0) PRECARGAR(congelado_campo(hash, hashes[i]));
+      continue;
+    }
+    size_t pos = posicion_de(hash, hashes[i]);
+    if (hash->control != NULL) PRECARGAR(&hash->control[pos]);
+    PRECARGAR(&hash->campos[pos]);
+  }
+  for (size_t i=0; i<n && !hash->congelado; i++){
+    const campo_t* campo = &hash->campos[posicion_de(hash, hashes[i])];
+    if (campo->hash == hashes[i] && campo->largo > HASH_CLAVE_CORTA) PRECARGAR(campo->clave.larga);
+  }
+  for (size_t i=0; i<n; i++){
+    encontrados[i] = hash_buscar_campo_h(hash, claves[i], largos[i], hashes[i]);
+  }
+}
+
+/* Mientras hay una migracion, las posiciones de 0 a capacidad-1 son las
+ * de la tabla nueva y las siguientes las de la vieja.
+ */
+static size_t iter_largo(const hash_t* hash){
+  return hash->capacidad + hash->capacidad_vieja;
+}
+
+static const campo_t* iter_campo(const hash_t* hash, size_t pos){
+  if (pos < hash->capacidad) return &hash->campos[pos];
+  return &hash->campos_viejos[pos - hash->capacidad];
+}
 
- bool campos_copiar(hash_t*hash, const char *clave, void *dato){
-    size_t pos;
-    if (hash_pertenece(hash, clave)){
-       pos = hash_buscar(hash, clave);
-       hash->campos[pos].valor = dato;
-       return true;
+/* Devuelve la primera posicion ocupada de [pos, fin), o fin si no hay.
+ * Con bytes de control (solo en sondeo por grupos) los lee de a 8: los
+ * ocupados tienen el bit alto apagado. En los otros modos, y en la tabla
+ * vieja, revisa campo por campo: no hay un mapa de ocupados aparte.
+ */
+static size_t siguiente_ocupado(const hash_t* hash, size_t pos, size_t fin){
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (hash->control != NULL){
+    size_t fin_control = fin < hash->capacidad ? fin : hash->capacidad;
+    while (pos + 8 <= fin_control){
+      uint64_t ocupados = ~leer64(hash->control + pos) & 0x8080808080808080ull;
+      if (ocupados) return pos + (primer_bit64(ocupados) >> 3);
+      pos += 8;
     }
-    campo_t campo = crear_campo(strdup(clave), dato, OCUPADO);
-    pos = hash_buscar_sig(hash, clave);
+  }
+#endif
+  size_t fin_nueva = fin < hash->capacidad ? fin : hash->capacidad;
+  while (pos < fin_nueva && hash->campos[pos].estado != OCUPADO) pos++;
+  if (pos < fin_nueva) return pos;
+  while (pos < fin && hash->campos_viejos[pos - hash->capacidad].estado != OCUPADO) pos++;
+  return pos;
+}
+
+/* ******************************************************************
+ *                    OPERACIONES EN PARALELO
+ * *****************************************************************/
+
+/* Para redimensionar y construir en lote la tabla nueva se divide en
+ * tramos consecutivos, uno por hilo, y cada hilo ubica solo los campos
+ * cuya posicion inicial cae en su tramo: ningun hilo escribe donde escribe
+ * otro. Los campos cuyo sondeo se pasa del final de su tramo se guardan
+ * aparte y se ubican al final, en un solo hilo. Si a un hilo no le alcanza
+ * el lugar para guardarlos, la tabla se rearma en secuencia. Robin Hood
+ * queda afuera: ahi el lugar de cada clave depende del orden de insercion.
+ */
+
+typedef struct tramo{
+  hash_t* hash;
+  size_t inicio;          // posiciones [inicio, fin) de la tabla nueva
+  size_t fin;
+  const campo_t* fuente;  // campos a ubicar
+  size_t fuente_tam;
+  size_t fuente_inicio;   // se recorre fuente desde aca hasta fuente_fin,
+  size_t fuente_fin;      // o hasta el primer VACIO despues si es circular
+  bool circular;
+  bool completo;          // false si no alcanzaron los desbordes
+  size_t desbordados;
+  campo_t desbordes[DESBORDE_MAX];
+}tramo_t;
+
+/* Cantidad de hilos (potencia de dos) para una tabla de tam posiciones. */
+static size_t hilos_para(const hash_t* hash, size_t tam){
+  if (hash->hilos < 2 || tam < PARALELO_MIN) return 1;
+  size_t hilos = 1;
+  while (hilos * 2 <= hash->hilos && hilos * 2 <= HILOS_MAX) hilos *= 2;
+  return hilos;
+}
+
+/* Ejecuta tarea sobre los n elementos de datos (de tam bytes cada uno),
+ * cada uno en un hilo; el ultimo en el hilo que llama, y tambien los que
+ * no se pudieron lanzar.
+ */
+static void paralelo_ejecutar(void* (*tarea)(void*), void* datos, size_t tam, size_t n){
+  pthread_t hilos[HILOS_MAX];
+  size_t lanzados = 0;
+  while (lanzados + 1 < n && pthread_create(&hilos[lanzados], NULL, tarea, (char*)datos + lanzados * tam) == 0){
+    lanzados++;
+  }
+  for (size_t i=lanzados; i<n; i++) tarea((char*)datos + i * tam);
+  for (size_t i=0; i<lanzados; i++) pthread_join(hilos[i], NULL);
+}
+
+/* Deja VACIO todo el arreglo de campos (y de control). */
+static void tabla_vaciar(hash_t* hash){
+  for (size_t i=0; i<hash->capacidad; i++) hash->campos[i] = crear_campo(NULL, 0, VACIO);
+  if (hash->control != NULL) memset(hash->control, CONTROL_VACIO, control_tam(hash->capacidad));
+}
+
+/* Ubica campo en el tramo, o lo guarda en los desbordes si el sondeo
+ * llega al final del tramo. Devuelve false si no hay mas lugar para
+ * desbordes.
+ */
+static inline bool tramo_ubicar(tramo_t* tramo, campo_t campo){
+  hash_t* hash = tramo->hash;
+  size_t pos = posicion_de(hash, campo.hash);
+  while (pos < tramo->fin && hash->campos[pos].estado == OCUPADO) pos++;
+  if (pos < tramo->fin){
     hash->campos[pos] = campo;
+    if (hash->control != NULL) control_fijar(hash, pos, CONTROL_ETIQUETA(campo.hash));
     return true;
   }
+  if (tramo->desbordados == DESBORDE_MAX) return tramo->completo = false;
+  tramo->desbordes[tramo->desbordados++] = campo;
+  return true;
+}
 
- bool hash_redimensionar(hash_t* hash, size_t tam){
-   campo_t* campos_nuevo = malloc(tam * sizeof(campo_t));
-   if (campos_nuevo == NULL) return false;
-   campo_t* campos_act = hash->campos;
-   hash->campos = campos_nuevo;
-   for (size_t i=0;i<tam; i++){
-     hash->campos[i] = crear_campo("", NULL, VACIO);
-   }
-   for (size_t i=0; i<hash->capacidad;i++){
-     if (campos_act[i].estado == OCUPADO){
-       campos_copiar(hash, campos_act[i].clave, campos_act[i].valor);
-     }
-   }
-   hash->capacidad = tam;
-   free(campos_act);
-   return true;
- }
+/* Tarea de cada hilo: vacia su tramo y ubica en el los campos de la
+ * fuente cuya posicion inicial cae en el.
+ */
+static void* tramo_ubicar_todos(void* extra){
+  tramo_t* tramo = extra;
+  hash_t* hash = tramo->hash;
+  for (size_t i=tramo->inicio; i<tramo->fin; i++) hash->campos[i] = crear_campo(NULL, 0, VACIO);
+  if (hash->control != NULL) memset(hash->control + tramo->inicio, CONTROL_VACIO, tramo->fin - tramo->inicio);
+  size_t pos = tramo->fuente_inicio;
+  for (size_t i=0; i<tramo->fuente_tam; i++){
+    const campo_t* campo = &tramo->fuente[pos];
+    if (pos == tramo->fuente_fin && !tramo->circular) break;
+    if (i >= tramo->fuente_fin - tramo->fuente_inicio && campo->estado == VACIO) break;
+    pos = pos + 1 == tramo->fuente_tam ? 0 : pos + 1;
+    if (campo->estado != OCUPADO) continue;
+    size_t inicio = posicion_de(hash, campo->hash);
+    if (inicio < tramo->inicio || inicio >= tramo->fin) continue;
+    if (!tramo_ubicar(tramo, *campo)) break;
+  }
+  return NULL;
+}
+
+/* Lanza los tramos sobre la tabla nueva, ya fijada en hash y sin
+ * inicializar, y ubica despues los desbordes. Devuelve false si algun
+ * tramo no termino; la tabla queda a medio armar.
+ */
+static bool tramos_ubicar(hash_t* hash, tramo_t* tramos, size_t hilos){
+  if (hash->control != NULL) memset(hash->control + hash->capacidad, CONTROL_VACIO, GRUPO_MAX - 1);
+  paralelo_ejecutar(tramo_ubicar_todos, tramos, sizeof(tramo_t), hilos);
+  for (size_t t=0; t<hilos; t++){
+    if (!tramos[t].completo) return false;
+  }
+  for (size_t t=0; t<hilos; t++){
+    for (size_t i=0; i<tramos[t].desbordados; i++) campo_reinsertar(hash, tramos[t].desbordes[i]);
+  }
+  return true;
+}
+
+/* Posicion de una tabla de capacidad_act que corresponde a pos de la
+ * actual: las posiciones iniciales salen de los bits altos del hash, asi
+ * que al duplicar (o dividir) la capacidad se escalan igual.
+ */
+static size_t escalar_posicion(size_t pos, size_t capacidad, size_t capacidad_act){
+  return capacidad_act >= capacidad ? pos * (capacidad_act / capacidad) : pos / (capacidad / capacidad_act);
+}
+
+/* Reubica en paralelo los campos de campos_act en la tabla nueva, ya
+ * fijada en hash. Las claves con posicion inicial en un tramo de la tabla
+ * nueva estan en el tramo escalado de la vieja o en el grupo de campos
+ * ocupados que lo sigue, asi que cada hilo recorre solo esa parte.
+ */
+static bool redimensionar_en_paralelo(hash_t* hash, const campo_t* campos_act, size_t capacidad_act, size_t hilos){
+  tramo_t* tramos = hash_pedir(hash, hilos * sizeof(tramo_t));
+  if (tramos == NULL) return false;
+  size_t tam_tramo = hash->capacidad / hilos;
+  for (size_t t=0; t<hilos; t++){
+    tramo_t* tramo = &tramos[t];
+    tramo->hash = hash;
+    tramo->inicio = t * tam_tramo;
+    tramo->fin = tramo->inicio + tam_tramo;
+    tramo->fuente = campos_act;
+    tramo->fuente_tam = capacidad_act;
+    tramo->fuente_inicio = escalar_posicion(tramo->inicio, hash->capacidad, capacidad_act);
+    tramo->fuente_fin = escalar_posicion(tramo->fin, hash->capacidad, capacidad_act);
+    tramo->circular = true;
+    tramo->completo = true;
+    tramo->desbordados = 0;
+  }
+  bool ok = tramos_ubicar(hash, tramos, hilos);
+  hash_liberar(hash, tramos, hilos * sizeof(tramo_t));
+  return ok;
+}
+
+/* Construccion en lote en paralelo. Primero cada hilo calcula, para su
+ * parte de las claves, los hashes, cuantas caen en cada tramo de la tabla
+ * y cuanto ocupan sus claves largas. Con eso se reserva la arena de una
+ * vez y cada hilo arma sus campos, copia sus claves en su parte de la
+ * arena y los deja agrupados por tramo en un arreglo auxiliar. Por ultimo
+ * cada hilo ubica los campos de su tramo.
+ */
+typedef struct lote{
+  hash_t* hash;
+  const char** claves;
+  void** valores;
+  size_t desde;             // claves [desde, hasta)
+  size_t hasta;
+  uint64_t* hashes;
+  size_t tam_tramo;
+  size_t cuentas[HILOS_MAX]; // claves que caen en cada tramo; luego, destino
+  size_t bytes_largas;       // luego, donde empiezan en la arena
+  char* arena;
+  campo_t* agrupados;
+  bool error;
+}lote_t;
+
+static void* lote_contar(void* extra){
+  lote_t* lote = extra;
+  for (size_t i=lote->desde; i<lote->hasta; i++){
+    size_t largo = strlen(lote->claves[i]);
+    if (largo > UINT32_MAX) lote->error = true;
+    lote->hashes[i] = hash_calcular(lote->hash, lote->claves[i], largo);
+    lote->cuentas[posicion_de(lote->hash, lote->hashes[i]) / lote->tam_tramo]++;
+    if (largo > HASH_CLAVE_CORTA) lote->bytes_largas += arena_alinear(clave_larga_tam(largo));
+  }
+  return NULL;
+}
+
+static void* lote_agrupar(void* extra){
+  lote_t* lote = extra;
+  char* arena = lote->arena + lote->bytes_largas;
+  for (size_t i=lote->desde; i<lote->hasta; i++){
+    size_t largo = strlen(lote->claves[i]);
+    campo_t campo = crear_campo(lote->valores != NULL ? lote->valores[i] : NULL, lote->hashes[i], OCUPADO);
+    campo.largo = (uint32_t)largo;
+    char* destino = campo.clave.corta;
+    if (largo > HASH_CLAVE_CORTA){
+      campo.clave.larga = (clave_larga_t*)arena;
+      campo.clave.larga->largo = largo;
+      destino = campo.clave.larga->bytes;
+      arena += arena_alinear(clave_larga_tam(largo));
+    }
+    memcpy(destino, lote->claves[i], largo + 1);
+    lote->agrupados[lote->cuentas[posicion_de(lote->hash, campo.hash) / lote->tam_tramo]++] = campo;
+  }
+  return NULL;
+}
+
+/* Devuelve false, sin haber tocado el hash, si no pudo construirlo en
+ * paralelo.
+ * Pre: el hash esta vacio y tiene lugar para las n claves.
+ */
+static bool construir_en_paralelo(hash_t* hash, const char** claves, void** valores, size_t n, size_t hilos){
+  lote_t* lotes = hash_pedir(hash, hilos * sizeof(lote_t));
+  tramo_t* tramos = hash_pedir(hash, hilos * sizeof(tramo_t));
+  uint64_t* hashes = hash_pedir(hash, n * sizeof(uint64_t));
+  campo_t* agrupados = hash_pedir(hash, n * sizeof(campo_t));
+  bool ok = lotes != NULL && tramos != NULL && hashes != NULL && agrupados != NULL;
+  size_t tam_tramo = hash->capacidad / hilos;
+  for (size_t t=0; ok && t<hilos; t++){
+    memset(&lotes[t], 0, sizeof(lote_t));
+    lotes[t].hash = hash;
+    lotes[t].claves = claves;
+    lotes[t].valores = valores;
+    lotes[t].desde = n / hilos * t;
+    lotes[t].hasta = t + 1 == hilos ? n : n / hilos * (t + 1);
+    lotes[t].hashes = hashes;
+    lotes[t].tam_tramo = tam_tramo;
+    lotes[t].agrupados = agrupados;
+  }
+  if (ok) paralelo_ejecutar(lote_contar, lotes, sizeof(lote_t), hilos);
+
+  // Cada tramo empieza donde termina el anterior; dentro de cada tramo,
+  // cada hilo escribe despues de los hilos anteriores.
+  size_t bytes_largas = 0, destino = 0;
+  for (size_t t=0; ok && t<hilos; t++){
+    ok = !lotes[t].error;
+    size_t bytes = lotes[t].bytes_largas;
+    lotes[t].bytes_largas = bytes_largas;
+    bytes_largas += bytes;
+  }
+  for (size_t tramo=0; ok && tramo<hilos; tramo++){
+    tramos[tramo].fuente_inicio = destino;
+    for (size_t t=0; t<hilos; t++){
+      size_t cuenta = lotes[t].cuentas[tramo];
+      lotes[t].cuentas[tramo] = destino;
+      destino += cuenta;
+    }
+    tramos[tramo].fuente_fin = destino;
+  }
+  if (ok && bytes_largas > 0){
+    ok = arena_agregar_bloque(&hash->arena, bytes_largas);
+    if (ok){
+      hash->arena.bloques->usado = bytes_largas;
+      hash->arena.usado += bytes_largas;
+      for (size_t t=0; t<hilos; t++) lotes[t].arena = (char*)hash->arena.bloques->datos;
+    }
+  }
+  if (ok){
+    paralelo_ejecutar(lote_agrupar, lotes, sizeof(lote_t), hilos);
+    for (size_t t=0; t<hilos; t++){
+      tramo_t* tramo = &tramos[t];
+      tramo->hash = hash;
+      tramo->inicio = t * tam_tramo;
+      tramo->fin = tramo->inicio + tam_tramo;
+      tramo->fuente = agrupados;
+      tramo->fuente_tam = n;
+      tramo->circular = false;
+      tramo->completo = true;
+      tramo->desbordados = 0;
+    }
+    if (!tramos_ubicar(hash, tramos, hilos)){
+      tabla_vaciar(hash);
+      for (size_t i=0; i<n; i++) campo_reinsertar(hash, agrupados[i]);
+    }
+    hash->cantidad = n;
+  }
+  hash_liberar(hash, agrupados, n * sizeof(campo_t));
+  hash_liberar(hash, hashes, n * sizeof(uint64_t));
+  hash_liberar(hash, tramos, hilos * sizeof(tramo_t));
+  hash_liberar(hash, lotes, hilos * sizeof(lote_t));
+  return ok;
+}
+
+typedef struct tramo_destruir{
+  const hash_t* hash;
+  size_t inicio;
+  size_t fin;
+}tramo_destruir_t;
+
+static void* tramo_destruir_datos(void* extra){
+  tramo_destruir_t* tramo = extra;
+  for (size_t i=tramo->inicio; i<tramo->fin; i++){
+    const campo_t* campo = iter_campo(tramo->hash, i);
+    if (campo->estado == OCUPADO) tramo->hash->funcion_destruccion(campo->valor);
+  }
+  return NULL;
+}
+
+/* Llama a la funcion de destruccion de todos los datos repartiendo las
+ * posiciones entre hilos. Devuelve false si no corresponde hacerlo en
+ * paralelo.
+ */
+static bool tabla_destruir_paralelo(const hash_t* hash){
+  size_t total = iter_largo(hash);
+  size_t hilos = hilos_para(hash, total);
+  if (!hash->destruir_en_paralelo || hash->funcion_destruccion == NULL || hilos < 2) return false;
+  tramo_destruir_t tramos[HILOS_MAX];
+  for (size_t t=0; t<hilos; t++){
+    tramos[t].hash = hash;
+    tramos[t].inicio = total / hilos * t;
+    tramos[t].fin = t + 1 == hilos ? total : total / hilos * (t + 1);
+  }
+  paralelo_ejecutar(tramo_destruir_datos, tramos, sizeof(tramo_destruir_t), hilos);
+  return true;
+}
+
+/* Pasa los campos a una tabla de tam posiciones. En modo incremental solo
+ * crea la tabla nueva y deja la actual para migrarla de a poco; si quedaba
+ * una migracion pendiente, la termina antes.
+ * Pre: tam es potencia de dos.
+ */
+static bool hash_redimensionar(hash_t* hash, size_t tam){
+  hash_migrar(hash, hash->capacidad_vieja);
+  // En paralelo cada hilo inicializa su tramo de la tabla nueva.
+  size_t hilos = 1;
+  if (!hash->incremental && hash->sondeo != HASH_SONDEO_ROBIN_HOOD) hilos = hilos_para(hash, tam);
+  campo_t* campos_nuevo = hilos > 1 ? hash_pedir(hash, tam * sizeof(campo_t)) : campos_crear(hash, tam);
+  if (campos_nuevo == NULL) return false;
+  if (hash->sondeo == HASH_SONDEO_GRUPOS){
+    uint8_t* control_nuevo = hilos > 1 ? hash_pedir(hash, control_tam(tam)) : control_crear(hash, tam);
+    if (control_nuevo == NULL){
+      hash_liberar(hash, campos_nuevo, tam * sizeof(campo_t));
+      return false;
+    }
+    hash_liberar(hash, hash->control, control_tam(hash->capacidad));
+    hash->control = control_nuevo;
+  }
+  campo_t* campos_act = hash->campos;
+  size_t capacidad_act = hash->capacidad;
+  unsigned desplazamiento_act = hash->desplazamiento;
+  hash->campos = campos_nuevo;
+  hash->redimensiones++;
+  hash->borrados = 0;
+  hash_fijar_capacidad(hash, tam);
+  if (hash->incremental){
+    hash->campos_viejos = campos_act;
+    hash->capacidad_vieja = capacidad_act;
+    hash->desplazamiento_viejo = desplazamiento_act;
+    hash->migrado = 0;
+    return true;
+  }
+  if (hilos > 1){
+    if (redimensionar_en_paralelo(hash, campos_act, capacidad_act, hilos)){
+      hash_liberar(hash, campos_act, capacidad_act * sizeof(campo_t));
+      return true;
+    }
+    tabla_vaciar(hash);
+  }
+  for (size_t i=0; i<capacidad_act;i++){
+    if (campos_act[i].estado == OCUPADO){
+      campo_reinsertar(hash, campos_act[i]);
+    }
+  }
+  hash_liberar(hash, campos_act, capacidad_act * sizeof(campo_t));
+  return true;
+}
+
+/* Limpia los BORRADO sin pedir memoria, reubicando las claves en el mismo
+ * arreglo: todas se marcan PENDIENTE y cada una se intercambia con la
+ * primera posicion no OCUPADO de su sondeo. Si ahi habia otra PENDIENTE,
+ * esa queda en la posicion liberada y se la reubica a continuacion. Una
+ * posicion OCUPADO no vuelve a cambiar, asi que el sondeo de las claves
+ * ya reubicadas nunca se corta. Solo para sondeo lineal y por grupos:
+ * Robin Hood no deja BORRADO.
+ */
+static void hash_recompactar(hash_t* hash){
+  hash_migrar(hash, hash->capacidad_vieja);
+  campo_t* campos = hash->campos;
+  for (size_t i=0; i<hash->capacidad; i++){
+    if (campos[i].estado == OCUPADO) campos[i].estado = PENDIENTE;
+    else campos[i] = crear_campo(NULL, 0, VACIO);
+  }
+  for (size_t i=0; i<hash->capacidad; i++){
+    while (campos[i].estado == PENDIENTE){
+      size_t destino = posicion_de(hash, campos[i].hash);
+      while (campos[destino].estado == OCUPADO) destino = (destino + 1) & hash->mascara;
+      campo_t campo = campos[i];
+      campo.estado = OCUPADO;
+      campos[i] = campos[destino];
+      campos[destino] = campo;
+    }
+  }
+  if (hash->sondeo == HASH_SONDEO_GRUPOS){
+    for (size_t i=0; i<hash->capacidad; i++){
+      control_fijar(hash, i, campos[i].estado == OCUPADO ? CONTROL_ETIQUETA(campos[i].hash) : CONTROL_VACIO);
+    }
+  }
+  hash->borrados = 0;
+  hash->recompactaciones++;
+}
+
+/* Devuelve la posicion de clave, cuyo hash es h, insertandola con dato
+ * NULL si no estaba. Deja en *insertado si hubo que agregarla. Devuelve
+ * NO_ENCONTRADO si no se pudo pedir memoria para la clave.
+ */
+static size_t hash_ubicar_o_insertar(hash_t* hash, const char* clave, size_t largo, uint64_t h, bool* insertado){
+  if (hash->congelado) return NO_ENCONTRADO;
+  bool encontrado;
+  hash_migrar(hash, MIGRACION_PASO);
+  size_t pos = hash_ubicar(hash, clave, largo, h, &encontrado);
+  *insertado = !encontrado;
+  if (encontrado) return pos;
+  if (hash->campos_viejos != NULL){
+    campo_t* viejo = viejos_buscar(hash, clave, largo, h);
+    if (viejo != NULL){
+      *insertado = false;
+      return viejo_migrar(hash, viejo);
+    }
+  }
+  // Los BORRADO alargan los sondeos igual que las claves: cuentan en la carga.
+  if (((double)(hash->cantidad + hash->borrados))/(double)hash->capacidad >= HASH_CARGA_MAX || pos == NO_ENCONTRADO){
+    if ((double)hash->borrados >= HASH_BORRADOS_MAX * (double)hash->capacidad){
+      hash_recompactar(hash);
+      pos = hash_buscar_sig(hash, h);
+    } else if (hash_redimensionar(hash, hash->capacidad*2)){
+      pos = hash_buscar_sig(hash, h);
+    }
+    // Si no se puede agrandar, la posicion ya encontrada sigue siendo valida.
+    if (pos == NO_ENCONTRADO) return NO_ENCONTRADO;
+  }
+  campo_t campo = crear_campo(NULL, h, OCUPADO);
+  if (!campo_copiar_clave(&hash->arena, &campo, clave, largo)) return NO_ENCONTRADO;
+  if (hash->sondeo == HASH_SONDEO_ROBIN_HOOD){
+    pos = robin_hood_insertar(hash, campo);
+  } else {
+    if (hash->campos[pos].estado == BORRADO) hash->borrados--;
+    if (hash->sondeo == HASH_SONDEO_GRUPOS) control_fijar(hash, pos, CONTROL_ETIQUETA(h));
+    hash->campos[pos] = campo;
+  }
+  hash->cantidad++;
+  return pos;
+}
+
+/* Copia las claves largas vivas a una arena de un solo bloque y libera la
+ * anterior, descartando la basura. Si no hay memoria la deja como estaba.
+ */
+static void arena_compactar(hash_t* hash){
+  arena_t nueva;
+  if (!arena_compactar_iniciar(&hash->arena, &nueva)) return;
+  for (size_t i=0; i<hash->capacidad; i++){
+    campo_t* campo = &hash->campos[i];
+    if (campo->estado != OCUPADO || campo->largo <= HASH_CLAVE_CORTA) continue;
+    campo->clave.larga = arena_mudar(&nueva, campo->clave.larga, clave_larga_tam(campo->largo));
+  }
+  arena_compactar_terminar(&hash->arena, &nueva);
+}
+
+/* Memoria de trabajo para armar la funcion perfecta. */
+typedef struct congelar{
+  const campo_t** fuentes;  // los campos ocupados de la tabla actual
+  uint32_t* por_cubeta;     // indices de fuentes ordenados por cubeta
+  uint32_t* inicio;         // por_cubeta[inicio[c]..inicio[c+1]) es la cubeta c
+  uint32_t* orden;          // cubetas de la mas grande a la mas chica
+  uint64_t* ocupado;        // bit por posicion ya tomada de la tabla congelada
+  uint32_t* pilotos;
+  campo_t* campos;
+  size_t n;
+  size_t cubetas;
+}congelar_t;
+
+static void congelar_liberar(const hash_t* hash, congelar_t* c, bool todo){
+  hash_liberar(hash, c->fuentes, (c->n + 1) * sizeof(campo_t*));
+  hash_liberar(hash, c->por_cubeta, (c->n + 1) * sizeof(uint32_t));
+  hash_liberar(hash, c->inicio, (c->cubetas + 1) * sizeof(uint32_t));
+  hash_liberar(hash, c->orden, c->cubetas * sizeof(uint32_t));
+  hash_liberar(hash, c->ocupado, (c->n / 64 + 1) * sizeof(uint64_t));
+  if (!todo) return;
+  hash_liberar(hash, c->pilotos, c->cubetas * sizeof(uint32_t));
+  hash_liberar(hash, c->campos, c->n * sizeof(campo_t));
+}
+
+/* Reparte las claves en cubetas (orden por conteo) y ordena las cubetas
+ * de mayor a menor: las grandes se ubican primero, cuando hay mas lugar.
+ * Devuelve false si alguna cubeta supera CONGELADO_CUBETA_MAX.
+ */
+static bool congelar_repartir(congelar_t* c){
+  memset(c->inicio, 0, (c->cubetas + 1) * sizeof(uint32_t));
+  for (size_t i=0; i<c->n; i++) c->inicio[congelado_cubeta(c->fuentes[i]->hash, c->cubetas) + 1]++;
+  size_t por_tam[CONGELADO_CUBETA_MAX + 2] = {0};
+  for (size_t b=0; b<c->cubetas; b++){
+    if (c->inicio[b + 1] > CONGELADO_CUBETA_MAX) return false;
+    por_tam[CONGELADO_CUBETA_MAX - c->inicio[b + 1] + 1]++;
+    c->inicio[b + 1] += c->inicio[b];
+  }
+  for (size_t i=0; i<c->n; i++) c->por_cubeta[c->inicio[congelado_cubeta(c->fuentes[i]->hash, c->cubetas)]++] = (uint32_t)i;
+  // Cada inicio[b] quedo en el de b+1: se corren uno a la derecha
+  for (size_t b=c->cubetas; b>0; b--) c->inicio[b] = c->inicio[b - 1];
+  c->inicio[0] = 0;
+  for (size_t t=1; t<=CONGELADO_CUBETA_MAX + 1; t++) por_tam[t] += por_tam[t - 1];
+  for (size_t b=0; b<c->cubetas; b++){
+    c->orden[por_tam[CONGELADO_CUBETA_MAX - (c->inicio[b + 1] - c->inicio[b])]++] = (uint32_t)b;
+  }
+  return true;
+}
+
+/* Busca el primer piloto con el que las claves de la cubeta b caen en
+ * posiciones libres y distintas, y las ubica. Devuelve false si dos claves
+ * tienen el mismo hash (ningun piloto las separa).
+ */
+static bool congelar_cubeta(congelar_t* c, size_t b){
+  const uint32_t* claves = &c->por_cubeta[c->inicio[b]];
+  size_t tam = c->inicio[b + 1] - c->inicio[b];
+  size_t pos[CONGELADO_CUBETA_MAX];
+  for (size_t i=0; i<tam; i++){
+    for (size_t j=0; j<i; j++){
+      if (c->fuentes[claves[i]]->hash == c->fuentes[claves[j]]->hash) return false;
+    }
+  }
+  for (uint64_t piloto=0; piloto<=UINT32_MAX; piloto++){
+    size_t i = 0;
+    for (; i<tam; i++){
+      pos[i] = congelado_posicion(c->fuentes[claves[i]]->hash, (uint32_t)piloto, c->n);
+      if (c->ocupado[pos[i] / 64] >> (pos[i] % 64) & 1) break;
+      size_t j = 0;
+      while (j < i && pos[j] != pos[i]) j++;
+      if (j < i) break;
+    }
+    if (i < tam) continue;
+    c->pilotos[b] = (uint32_t)piloto;
+    for (i=0; i<tam; i++){
+      c->ocupado[pos[i] / 64] |= (uint64_t)1 << (pos[i] % 64);
+      c->campos[pos[i]] = *c->fuentes[claves[i]];
+      c->campos[pos[i]].distancia = 0;
+    }
+    return true;
+  }
+  return false;
+}
 
 /* ******************************************************************
  *                       PRIMITIVAS DEL HASH
  * *****************************************************************/
 
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
-   hash_t* hash = malloc(sizeof(hash_t));
+   return hash_crear_con_opciones(destruir_dato, NULL);
+ }
+
+hash_t *hash_crear_con_allocator(hash_destruir_dato_t destruir_dato, const hash_allocator_t *allocator){
+   hash_opciones_t opciones = {0};
+   opciones.allocator = allocator;
+   return hash_crear_con_opciones(destruir_dato, &opciones);
+ }
+
+hash_t *hash_crear_con_capacidad(size_t n, hash_destruir_dato_t destruir_dato){
+   hash_opciones_t opciones = {0};
+   opciones.capacidad = n;
+   return hash_crear_con_opciones(destruir_dato, &opciones);
+ }
+
+hash_t *hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones){
+   hash_opciones_t por_omision = {0};
+   if (opciones == NULL) opciones = &por_omision;
+   const hash_allocator_t* allocator = opciones->allocator ? opciones->allocator : &HASH_ALLOCATOR_MALLOC;
+   hash_t* hash = allocator->pedir(allocator->contexto, sizeof(hash_t));
+   if (hash == NULL) return NULL;
+   hash->allocator = *allocator;
    hash->cantidad = 0;
-   hash->capacidad = TAM_INICIAL;
+   hash->borrados = 0;
+   hash->reservada = opciones->capacidad > 0 ? hash_capacidad_para(opciones->capacidad) : 0;
    hash->funcion_destruccion = destruir_dato;
-   hash->campos = malloc(TAM_INICIAL*sizeof(campo_t));
-   for (size_t i=0;i<TAM_INICIAL; i++){
-     hash->campos[i] = crear_campo("", NULL, VACIO);
+   hash->sondeo = opciones->sondeo;
+   if (opciones->funcion_propia != NULL){
+     hash->funcion_hash = opciones->funcion_propia;
+   } else if (opciones->funcion == HASH_FUNCION_CLASICA){
+     hash->funcion_hash = fhash;
+   } else {
+     hash->funcion_hash = fhash_rapida;
+   }
+   hash->semilla = opciones->semilla != 0 ? opciones->semilla : hash_semilla_aleatoria(hash);
+   arena_crear(&hash->arena, &hash->allocator);
+   hash->incremental = opciones->incremental;
+   hash->campos_viejos = NULL;
+   hash->capacidad_vieja = 0;
+   hash->desplazamiento_viejo = 0;
+   hash->migrado = 0;
+   hash->hilos = opciones->hilos;
+   hash->destruir_en_paralelo = opciones->destruir_en_paralelo;
+   hash->congelado = false;
+   hash->pilotos = NULL;
+   hash->cantidad_pilotos = 0;
+   hash->redimensiones = 0;
+   hash->recompactaciones = 0;
+#ifdef HASH_ESTADISTICAS
+   hash->aciertos = 0;
+   hash->fallos = 0;
+#endif
+   hash_fijar_capacidad(hash, capacidad_minima(hash));
+   hash->campos = campos_crear(hash, hash->capacidad);
+   hash->control = NULL;
+   if (hash->sondeo == HASH_SONDEO_GRUPOS){
+     grupos_elegir(hash);
+     hash->control = control_crear(hash, hash->capacidad);
+   }
+   if (hash->campos == NULL || (hash->sondeo == HASH_SONDEO_GRUPOS && hash->control == NULL)){
+     hash_liberar(hash, hash->campos, hash->capacidad * sizeof(campo_t));
+     hash_liberar(hash, hash->control, control_tam(hash->capacidad));
+     hash_liberar(hash, hash, sizeof(hash_t));
+     return NULL;
    }
    return hash;
  }
 
 
+bool hash_reservar(hash_t *hash, size_t n){
+  if (hash->congelado) return false;
+  size_t tam = hash_capacidad_para(n);
+  if (tam > hash->reservada) hash->reservada = tam;
+  if (tam <= hash->capacidad) return true;
+  return hash_redimensionar(hash, tam);
+}
 
+/* Como las claves son distintas y la tabla ya tiene el tamaño final, cada
+ * clave se ubica directo en su primer lugar libre, igual que al
+ * redimensionar.
+ */
+hash_t *hash_construir_lote(const char **claves, void **valores, size_t n, hash_destruir_dato_t destruir_dato){
+  return hash_construir_lote_con_opciones(claves, valores, n, destruir_dato, NULL);
+}
 
-bool hash_guardar(hash_t *hash, const char *clave, void *dato){
-  size_t pos;
-  if (hash_pertenece(hash, clave)){
-     pos = hash_buscar(hash, clave);
-     hash->campos[pos].valor = dato;
-     return true;
+hash_t *hash_construir_lote_con_opciones(const char **claves, void **valores, size_t n,
+                                         hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones){
+  hash_opciones_t con_capacidad = {0};
+  if (opciones != NULL) con_capacidad = *opciones;
+  if (con_capacidad.capacidad < n) con_capacidad.capacidad = n;
+  hash_t* hash = hash_crear_con_opciones(destruir_dato, &con_capacidad);
+  if (hash == NULL) return NULL;
+  if (hash->sondeo != HASH_SONDEO_ROBIN_HOOD){
+    size_t hilos = hilos_para(hash, hash->capacidad);
+    if (hilos > 1 && construir_en_paralelo(hash, claves, valores, n, hilos)) return hash;
   }
-  if (((double)hash->cantidad)/(double)hash->capacidad >= CARGA_MAX){
+  for (size_t i=0; i<n; i++){
+    size_t largo = strlen(claves[i]);
+    campo_t campo = crear_campo(valores != NULL ? valores[i] : NULL, hash_calcular(hash, claves[i], largo), OCUPADO);
+    if (!campo_copiar_clave(&hash->arena, &campo, claves[i], largo)){
+      hash->funcion_destruccion = NULL;
+      hash_destruir(hash);
+      return NULL;
+    }
+    campo_reinsertar(hash, campo);
+    hash->cantidad++;
+  }
+  return hash;
+}
 
-    hash_redimensionar(hash, hash->capacidad*2);
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+  return hash_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+bool hash_guardar_n(hash_t *hash, const char *clave, size_t largo, void *dato){
+  return hash_guardar_con_hash(hash, clave, largo, hash_calcular(hash, clave, largo), dato);
+}
+
+bool hash_guardar_con_hash(hash_t *hash, const char *clave, size_t largo, uint64_t h, void *dato){
+  bool insertado;
+  size_t pos = hash_ubicar_o_insertar(hash, clave, largo, h, &insertado);
+  if (pos == NO_ENCONTRADO) return false;
+  if (!insertado && hash->funcion_destruccion != NULL){
+    hash->funcion_destruccion(hash->campos[pos].valor);
   }
-  campo_t campo = crear_campo(strdup(clave), dato, OCUPADO);
-  pos = hash_buscar_sig(hash, clave);
-  hash->campos[pos] = campo;
-  hash->cantidad++;
+  hash->campos[pos].valor = dato;
   return true;
 }
 
+void **hash_obtener_o_insertar(hash_t *hash, const char *clave){
+  return hash_obtener_o_insertar_n(hash, clave, strlen(clave));
+}
+
+void **hash_obtener_o_insertar_n(hash_t *hash, const char *clave, size_t largo){
+  bool insertado;
+  size_t pos = hash_ubicar_o_insertar(hash, clave, largo, hash_calcular(hash, clave, largo), &insertado);
+  if (pos == NO_ENCONTRADO) return NULL;
+  return &hash->campos[pos].valor;
+}
+
 void *hash_borrar(hash_t *hash, const char *clave){
-   size_t pos;
-   if (!hash_pertenece(hash, clave)) return NULL;
-   pos = hash_buscar(hash, clave);
-   //AGREGAR FUNCION DE DESTRUCCION.
+   return hash_borrar_n(hash, clave, strlen(clave));
+}
+
+void *hash_borrar_n(hash_t *hash, const char *clave, size_t largo){
+   return hash_borrar_con_hash(hash, clave, largo, hash_calcular(hash, clave, largo));
+}
+
+void *hash_borrar_con_hash(hash_t *hash, const char *clave, size_t largo, uint64_t h){
+   if (hash->cantidad == 0 || hash->congelado) return NULL;
+   hash_migrar(hash, MIGRACION_PASO);
+   bool encontrado;
+   size_t pos = hash_ubicar(hash, clave, largo, h, &encontrado);
+   if (!encontrado){
+     campo_t* viejo = hash->campos_viejos ? viejos_buscar(hash, clave, largo, h) : NULL;
+     if (viejo == NULL) return NULL;
+     campo_liberar_clave(&hash->arena, viejo);
+     viejo->estado = BORRADO;
+     hash->cantidad--;
+     return viejo->valor;
+   }
    void* dato = hash->campos[pos].valor;
-   hash->campos[pos].estado = BORRADO;
-   hash->campos[pos].valor = NULL;
-   hash->campos[pos].clave ="";
-   if ((double)hash->cantidad/(double)hash->capacidad <= CARGA_MIN && hash->capacidad/2>TAM_INICIAL){
-     hash_redimensionar(hash, hash->capacidad/2);
+   campo_liberar_clave(&hash->arena, &hash->campos[pos]);
+   if (hash->sondeo == HASH_SONDEO_ROBIN_HOOD){
+     robin_hood_borrar(hash, pos);
+   } else {
+     if (hash->sondeo == HASH_SONDEO_GRUPOS) control_fijar(hash, pos, CONTROL_BORRADO);
+     hash->campos[pos] = crear_campo(NULL, 0, BORRADO);
+     hash->borrados++;
    }
    hash->cantidad--;
+   // Mientras se migra no se achica la tabla ni se mueven las claves.
+   if (hash->campos_viejos != NULL) return dato;
+   if ((double)hash->cantidad/(double)hash->capacidad <= HASH_CARGA_MIN && hash->capacidad/2>=capacidad_minima(hash)){
+     hash_redimensionar(hash, hash->capacidad/2);
+   }
+   if (hash->campos_viejos == NULL && arena_hay_que_compactar(&hash->arena)){
+     arena_compactar(hash);
+   }
    return dato;
 }
 
+void **hash_buscar_ptr(const hash_t *hash, const char *clave){
+   return hash_buscar_ptr_n(hash, clave, strlen(clave));
+}
+
+void **hash_buscar_ptr_n(const hash_t *hash, const char *clave, size_t largo){
+   if (hash->cantidad == 0){
+     CONTAR(hash, fallos);
+     return NULL;
+   }
+   campo_t* campo = hash_buscar_campo(hash, clave, largo);
+   return campo != NULL ? &campo->valor : NULL;
+}
+
 void *hash_obtener(const hash_t *hash, const char *clave){
-   bool ok;
-   ok = hash_pertenece(hash, clave);
-   if (ok) return hash->campos[hash_buscar(hash, clave)].valor;
-   return NULL;
+   return hash_obtener_n(hash, clave, strlen(clave));
+}
+
+void *hash_obtener_n(const hash_t *hash, const char *clave, size_t largo){
+   void** dato = hash_buscar_ptr_n(hash, clave, largo);
+   return dato != NULL ? *dato : NULL;
+}
+
+void *hash_obtener_con_hash(const hash_t *hash, const char *clave, size_t largo, uint64_t h){
+   if (hash->cantidad == 0){
+     CONTAR(hash, fallos);
+     return NULL;
+   }
+   campo_t* campo = hash_buscar_campo_h(hash, clave, largo, h);
+   return campo != NULL ? campo->valor : NULL;
 }
 
 bool hash_pertenece(const hash_t *hash, const char *clave){
-  size_t indice = fhash(clave, hash->capacidad);
-  size_t pos_act = 0;
-  if (hash->cantidad == 0) return false;
-  for (size_t i=0; i<hash->capacidad; i++){
-    pos_act = (indice+i)%hash->capacidad;
-    if (strcmp(hash->campos[pos_act].clave,clave)==0 && hash->campos[pos_act].estado == OCUPADO){
-      return true;
+  return hash_pertenece_n(hash, clave, strlen(clave));
+}
+
+bool hash_pertenece_n(const hash_t *hash, const char *clave, size_t largo){
+  if (hash->cantidad == 0){
+    CONTAR(hash, fallos);
+    return false;
+  }
+  return hash_buscar_campo(hash, clave, largo) != NULL;
+}
+
+bool hash_pertenece_con_hash(const hash_t *hash, const char *clave, size_t largo, uint64_t h){
+  if (hash->cantidad == 0){
+    CONTAR(hash, fallos);
+    return false;
+  }
+  return hash_buscar_campo_h(hash, clave, largo, h) != NULL;
+}
+
+void hash_obtener_lote(const hash_t *hash, const char **claves, size_t n, void **resultados){
+  campo_t* encontrados[LOTE_BLOQUE];
+  for (size_t inicio=0; inicio<n; inicio += LOTE_BLOQUE){
+    size_t tam = n - inicio < LOTE_BLOQUE ? n - inicio : LOTE_BLOQUE;
+    hash_buscar_bloque(hash, claves + inicio, tam, encontrados);
+    for (size_t i=0; i<tam; i++){
+      resultados[inicio + i] = encontrados[i] != NULL ? encontrados[i]->valor : NULL;
+    }
+  }
+}
+
+void hash_pertenece_lote(const hash_t *hash, const char **claves, size_t n, bool *resultados){
+  campo_t* encontrados[LOTE_BLOQUE];
+  for (size_t inicio=0; inicio<n; inicio += LOTE_BLOQUE){
+    size_t tam = n - inicio < LOTE_BLOQUE ? n - inicio : LOTE_BLOQUE;
+    hash_buscar_bloque(hash, claves + inicio, tam, encontrados);
+    for (size_t i=0; i<tam; i++){
+      resultados[inicio + i] = encontrados[i] != NULL;
     }
   }
-  return false;
 }
 
 size_t hash_cantidad(const hash_t *hash){
   return hash->cantidad;
 }
 
+bool hash_congelar(hash_t *hash){
+  if (hash->congelado) return true;
+  if (hash->cantidad > UINT32_MAX) return false;
+  congelar_t c;
+  c.n = hash->cantidad;
+  c.cubetas = c.n / CONGELADO_CUBETA + 1;
+  c.fuentes = hash_pedir(hash, (c.n + 1) * sizeof(campo_t*));
+  c.por_cubeta = hash_pedir(hash, (c.n + 1) * sizeof(uint32_t));
+  c.inicio = hash_pedir(hash, (c.cubetas + 1) * sizeof(uint32_t));
+  c.orden = hash_pedir(hash, c.cubetas * sizeof(uint32_t));
+  c.ocupado = hash_pedir(hash, (c.n / 64 + 1) * sizeof(uint64_t));
+  c.pilotos = hash_pedir(hash, c.cubetas * sizeof(uint32_t));
+  c.campos = c.n > 0 ? hash_pedir(hash, c.n * sizeof(campo_t)) : NULL;
+  bool ok = c.fuentes && c.por_cubeta && c.inicio && c.orden && c.ocupado && c.pilotos && (c.campos || c.n == 0);
+  if (ok){
+    size_t k = 0;
+    for (size_t i=0; i<iter_largo(hash); i++){
+      const campo_t* campo = iter_campo(hash, i);
+      if (campo->estado == OCUPADO) c.fuentes[k++] = campo;
+    }
+    memset(c.ocupado, 0, (c.n / 64 + 1) * sizeof(uint64_t));
+    memset(c.pilotos, 0, c.cubetas * sizeof(uint32_t));
+    ok = congelar_repartir(&c);
+  }
+  for (size_t i=0; ok && i<c.cubetas; i++) ok = congelar_cubeta(&c, c.orden[i]);
+  if (!ok){
+    congelar_liberar(hash, &c, true);
+    return false;
+  }
+  congelar_liberar(hash, &c, false);
+
+  hash_liberar(hash, hash->campos_viejos, hash->capacidad_vieja * sizeof(campo_t));
+  hash_liberar(hash, hash->campos, hash->capacidad * sizeof(campo_t));
+  hash_liberar(hash, hash->control, control_tam(hash->capacidad));
+  hash->campos_viejos = NULL;
+  hash->capacidad_vieja = 0;
+  hash->control = NULL;
+  hash->campos = c.campos;
+  hash->capacidad = c.n;
+  hash->mascara = 0;
+  hash->pilotos = c.pilotos;
+  hash->cantidad_pilotos = c.cubetas;
+  hash->borrados = 0;
+  hash->congelado = true;
+  if (hash->arena.basura > 0) arena_compactar(hash);
+  return true;
+}
+
+bool hash_congelado(const hash_t *hash){
+  return hash->congelado;
+}
+
 void hash_destruir(hash_t *hash){
-  for (size_t i=0; i<hash->capacidad; i++){
-    if (hash->campos[i].estado != OCUPADO) continue;
-    if (hash->funcion_destruccion != NULL){
-      hash->funcion_destruccion(hash->campos[i].valor);
+  if (!tabla_destruir_paralelo(hash)){
+    for (size_t i=0; i<iter_largo(hash); i++){
+      const campo_t* campo = iter_campo(hash, i);
+      if (campo->estado != OCUPADO) continue;
+      if (hash->funcion_destruccion != NULL){
+        hash->funcion_destruccion(campo->valor);
+      }
     }
   }
-  free(hash->campos);
-  free(hash);
+  arena_destruir(&hash->arena);
+  hash_liberar(hash, hash->campos_viejos, hash->capacidad_vieja * sizeof(campo_t));
+  hash_liberar(hash, hash->campos, hash->capacidad * sizeof(campo_t));
+  hash_liberar(hash, hash->control, control_tam(hash->capacidad));
+  hash_liberar(hash, hash->pilotos, hash->cantidad_pilotos * sizeof(uint32_t));
+  hash_allocator_t allocator = hash->allocator;
+  allocator.liberar(allocator.contexto, hash, sizeof(hash_t));
+}
+
+void hash_memoria(const hash_t *hash, hash_memoria_t *memoria){
+  memoria->bytes_campos = hash->capacidad * sizeof(campo_t);
+  if (hash->control != NULL) memoria->bytes_campos += control_tam(hash->capacidad);
+  memoria->bytes_campos += hash->capacidad_vieja * sizeof(campo_t);
+  memoria->bytes_campos += hash->cantidad_pilotos * sizeof(uint32_t);
+  memoria->bytes_claves = hash->arena.reservado;
+  memoria->bytes_claves_usados = hash->arena.usado;
+  memoria->bytes_basura = hash->arena.basura;
+  memoria->bytes_total = sizeof(hash_t) + memoria->bytes_campos + memoria->bytes_claves;
+}
+
+/* Suma al histograma las claves de una tabla de capacidad posiciones, con
+ * la posicion inicial que da desplazamiento, y cuenta sus BORRADO.
+ */
+static void estadisticas_tabla(const campo_t* campos, size_t capacidad, unsigned desplazamiento,
+                        hash_estadisticas_t* estadisticas, size_t* total){
+  for (size_t i=0; i<capacidad; i++){
+    if (campos[i].estado == BORRADO) estadisticas->borrados++;
+    if (campos[i].estado != OCUPADO) continue;
+    size_t inicio = (size_t)((campos[i].hash * HASH_FIBONACCI) >> desplazamiento);
+    size_t largo = ((i - inicio) & (capacidad - 1)) + 1;
+    size_t cubeta = 0;
+    while (cubeta + 1 < HASH_HISTOGRAMA && largo >> (cubeta + 1)) cubeta++;
+    estadisticas->histograma[cubeta]++;
+    if (largo > estadisticas->sondeo_max) estadisticas->sondeo_max = largo;
+    *total += largo;
+  }
+}
+
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas){
+  memset(estadisticas, 0, sizeof(hash_estadisticas_t));
+  estadisticas->cantidad = hash->cantidad;
+  estadisticas->capacidad = iter_largo(hash);
+  if (estadisticas->capacidad > 0) estadisticas->carga = (double)hash->cantidad / (double)estadisticas->capacidad;
+  size_t total = 0;
+  if (hash->congelado){
+    // Cada clave esta en la unica posicion que se mira
+    estadisticas->histograma[0] = hash->cantidad;
+    estadisticas->sondeo_max = hash->cantidad > 0;
+    total = hash->cantidad;
+  } else {
+    estadisticas_tabla(hash->campos, hash->capacidad, hash->desplazamiento, estadisticas, &total);
+    estadisticas_tabla(hash->campos_viejos, hash->capacidad_vieja, hash->desplazamiento_viejo, estadisticas, &total);
+  }
+  if (hash->cantidad > 0) estadisticas->sondeo_promedio = (double)total / (double)hash->cantidad;
+  estadisticas->redimensiones = hash->redimensiones;
+  estadisticas->recompactaciones = hash->recompactaciones;
+  hash_memoria_t memoria;
+  hash_memoria(hash, &memoria);
+  estadisticas->bytes_campos = memoria.bytes_campos;
+  estadisticas->bytes_claves = memoria.bytes_claves;
+#ifdef HASH_ESTADISTICAS
+  estadisticas->contadores = true;
+  estadisticas->aciertos = LEER_CONTADOR(hash, aciertos);
+  estadisticas->fallos = LEER_CONTADOR(hash, fallos);
+#endif
+}
+
+void hash_informe_sondeo(const hash_t *hash, hash_informe_sondeo_t *informe){
+  hash_estadisticas_t estadisticas;
+  hash_estadisticas(hash, &estadisticas);
+  informe->colisiones = estadisticas.cantidad - estadisticas.histograma[0];
+  informe->largo_max = estadisticas.sondeo_max;
+  informe->largo_promedio = estadisticas.sondeo_promedio;
 }
 
 void imprimir(const hash_t* hash){
   printf("%s\n","IMPRESION DE HASH" );
-  for (size_t i=0; i<hash->capacidad; i++){
-    if (hash->campos[i].estado==OCUPADO){
-      printf("%s\n", hash->campos[i].clave);
+  for (size_t i=0; i<iter_largo(hash); i++){
+    const campo_t* campo = iter_campo(hash, i);
+    if (campo->estado==OCUPADO){
+      printf("%s\n", campo_clave(campo));
     }
-    if (hash->campos[i].estado == VACIO){
+    if (campo->estado == VACIO){
       printf("%s\n", "VACIO");
     }
-    if (hash->campos[i].estado == BORRADO){
+    if (campo->estado == BORRADO){
       printf("%s\n", "BORRADO");
     }
   }
@@ -236,42 +1708,70 @@ void imprimir(const hash_t* hash){
  * *****************************************************************/
 
 hash_iter_t *hash_iter_crear(const hash_t *hash){
-  hash_iter_t* iter = malloc(sizeof(hash_iter_t));
+  return hash_iter_crear_rango(hash, 0, iter_largo(hash));
+}
+
+hash_iter_t *hash_iter_crear_rango(const hash_t *hash, size_t inicio, size_t fin){
+  hash_iter_t* iter = hash_pedir(hash, sizeof(hash_iter_t));
   if (iter == NULL) return NULL;
   iter->hash = hash;
-  if (iter->hash->cantidad ==0){
-    iter->posicion = 0;
-    iter->campo_act = iter->hash->campos[0];
-    return iter;
-  }
-  iter->posicion = 0;
-  while (iter->hash->campos[iter->posicion].estado != OCUPADO){
-    iter->posicion++;
-  }
-  iter->campo_act = iter->hash->campos[iter->posicion];
+  iter->fin = fin < iter_largo(hash) ? fin : iter_largo(hash);
+  iter->posicion = inicio < iter->fin ? siguiente_ocupado(hash, inicio, iter->fin) : iter->fin;
   return iter;
 }
 
 bool hash_iter_avanzar(hash_iter_t *iter){
   if (hash_iter_al_final(iter)) return false;
-  iter->posicion++;
-  iter->campo_act = iter->hash->campos[iter->posicion];
-  if (iter->campo_act.estado != OCUPADO) hash_iter_avanzar(iter);
+  iter->posicion = siguiente_ocupado(iter->hash, iter->posicion + 1, iter->fin);
   return true;
 }
 
 const char *hash_iter_ver_actual(const hash_iter_t *iter){
   if (hash_iter_al_final(iter)) return NULL;
   if (iter->hash->cantidad == 0) return NULL;
-  return iter->campo_act.clave;
+  return campo_clave(iter_campo(iter->hash, iter->posicion));
+}
+
+void *hash_iter_ver_dato(const hash_iter_t *iter){
+  if (hash_iter_al_final(iter)) return NULL;
+  return iter_campo(iter->hash, iter->posicion)->valor;
+}
+
+bool hash_iter_ver_par(const hash_iter_t *iter, const char **clave, size_t *largo, void **dato){
+  if (hash_iter_al_final(iter)) return false;
+  const campo_t* campo = iter_campo(iter->hash, iter->posicion);
+  if (clave) *clave = campo_clave(campo);
+  if (largo) *largo = campo->largo;
+  if (dato) *dato = campo->valor;
+  return true;
 }
 
 bool hash_iter_al_final(const hash_iter_t *iter){
   if (iter->hash->cantidad == 0) return true;
-  if (iter->hash->capacidad == iter->posicion) return true;
+  if (iter->posicion >= iter->fin) return true;
   return false;
 }
 
 void hash_iter_destruir(hash_iter_t* iter){
-  free(iter);
+  hash_liberar(iter->hash, iter, sizeof(hash_iter_t));
+}
+
+void hash_para_cada(const hash_t *hash, bool visitar(const char *clave, size_t largo, void *dato, void *extra), void *extra){
+  size_t largo = iter_largo(hash);
+  for (size_t pos = siguiente_ocupado(hash, 0, largo); pos < largo; pos = siguiente_ocupado(hash, pos + 1, largo)){
+    const campo_t* campo = iter_campo(hash, pos);
+    if (!visitar(campo_clave(campo), campo->largo, campo->valor, extra)) return;
+  }
+}
+
+size_t hash_posiciones(const hash_t *hash){
+  return iter_largo(hash);
+}
+
+size_t hash_dividir_rangos(const hash_t *hash, size_t k, size_t *limites){
+  size_t total = iter_largo(hash);
+  if (k > total) k = total;
+  if (k == 0) k = 1;
+  for (size_t i=0; i<=k; i++) limites[i] = total / k * i + (i * (total % k)) / k;
+  return k;
 }
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
@@ -14,10 +15,106 @@ typedef struct hash_iter hash_iter_t;
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// tipo de función de hash: recibe la clave, su largo en bytes y una semilla.
+typedef uint64_t (*hash_funcion_hash_t)(const void *clave, size_t largo, uint64_t semilla);
+
+// Las funciones de hash incluidas, también para usarlas fuera del hash.
+uint64_t fhash_rapida(const void *clave, size_t largo, uint64_t semilla);
+uint64_t fhash(const void *clave, size_t largo, uint64_t semilla);
+
+// Funciones de hash que se pueden elegir al crear el hash.
+typedef enum hash_funcion{
+  HASH_FUNCION_RAPIDA,  // 64 bits, de a una palabra, con semilla por tabla
+  HASH_FUNCION_CLASICA, // polinomio 31*h + c byte a byte (la original)
+} hash_funcion_t;
+
+// Estrategias de direccionamiento abierto.
+typedef enum hash_sondeo{
+  HASH_SONDEO_LINEAL,      // sondeo lineal; al borrar deja campos BORRADO
+  HASH_SONDEO_ROBIN_HOOD,  // Robin Hood; borra corriendo claves hacia atrás
+  HASH_SONDEO_GRUPOS,      // lineal sobre bytes de control, de a 16/32 con SIMD
+} hash_sondeo_t;
+
+/* Allocator: toda la memoria del hash (la estructura, los campos, las
+ * claves largas y los iteradores) se pide y se devuelve por estas
+ * funciones, que reciben el contexto como primer parámetro. liberar
+ * recibe el mismo tamaño con el que se pidió el bloque.
+ */
+typedef struct hash_allocator{
+  void *(*pedir)(void *contexto, size_t tam);
+  void (*liberar)(void *contexto, void *ptr, size_t tam);
+  void *contexto;
+} hash_allocator_t;
+
+// Opciones de creación. Un struct inicializado en cero equivale a hash_crear.
+typedef struct hash_opciones{
+  hash_funcion_t funcion;
+  hash_sondeo_t sondeo;
+  hash_funcion_hash_t funcion_propia; // si no es NULL, reemplaza a funcion
+  uint64_t semilla;                   // 0 elige una semilla al azar
+  const hash_allocator_t *allocator;  // NULL usa malloc y free
+  bool incremental;                   // redimensionar de a poco, ver abajo
+  size_t capacidad;                   // elementos que entran sin redimensionar
+  size_t hilos;                       // hilos para operaciones masivas, ver abajo
+  bool destruir_en_paralelo;          // destruir_dato se puede llamar desde varios hilos
+} hash_opciones_t;
+
+/* Operaciones masivas en paralelo: con hilos > 1, redimensionar (salvo en
+ * modo incremental), construir en lote y destruir reparten las tablas
+ * grandes entre hasta esa cantidad de hilos. Destruir solo llama a
+ * destruir_dato desde varios hilos si destruir_en_paralelo es true. Con
+ * HASH_SONDEO_ROBIN_HOOD redimensionar y construir siguen en un solo hilo.
+ * Si las opciones traen un allocator, solo se lo llama desde el hilo que
+ * usa el hash.
+ */
+
+/* Redimensionado incremental: al crecer o achicarse, la tabla vieja se
+ * conserva junto a la nueva y cada guardar o borrar mueve a lo sumo unas
+ * pocas posiciones de una a otra, en lugar de reinsertar todo de una vez.
+ * Mientras dura la migracion las busquedas consultan ambas tablas.
+ */
+
 /* Crea el hash
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* Crea el hash con las opciones indicadas. Si opciones es NULL se usan
+ * las mismas que en hash_crear. Devuelve NULL si no pudo crearlo.
+ */
+hash_t *hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+/* Crea el hash pidiendo toda su memoria a allocator, que se copia y debe
+ * seguir siendo válido (su contexto) hasta destruir el hash.
+ */
+hash_t *hash_crear_con_allocator(hash_destruir_dato_t destruir_dato, const hash_allocator_t *allocator);
+
+/* Crea el hash con lugar para n elementos: hasta n no se redimensiona, y
+ * al borrar no se achica por debajo de esa capacidad.
+ */
+hash_t *hash_crear_con_capacidad(size_t n, hash_destruir_dato_t destruir_dato);
+
+/* Agranda el hash, si hace falta, para que entren n elementos en total sin
+ * redimensionar; tampoco se achica luego por debajo de eso. Devuelve false
+ * si no pudo pedir la memoria.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t n);
+
+/* Crea un hash con los n pares (claves[i], valores[i]) dimensionado una
+ * sola vez. valores puede ser NULL (todos los datos son NULL). Como no
+ * busca cada clave antes de guardarla, las claves tienen que ser
+ * distintas. Devuelve NULL si no pudo crearlo; en ese caso no destruye
+ * ningun valor.
+ * Pre: las n claves son distintas entre si.
+ */
+hash_t *hash_construir_lote(const char **claves, void **valores, size_t n, hash_destruir_dato_t destruir_dato);
+
+/* Igual que hash_construir_lote, creando el hash con opciones (que puede
+ * ser NULL). La capacidad se agranda, si hace falta, hasta n.
+ */
+hash_t *hash_construir_lote_con_opciones(const char **claves, void **valores, size_t n,
+                                         hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -25,6 +122,40 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
  */
 bool hash_guardar(hash_t *hash, const char *clave, void *dato);
 
+/* Variantes _n: la clave son los primeros largo bytes de clave, que no
+ * necesita terminar en '\0' (y puede contener '\0'). Por lo demás se
+ * comportan igual que la primitiva sin _n.
+ */
+bool hash_guardar_n(hash_t *hash, const char *clave, size_t largo, void *dato);
+void **hash_obtener_o_insertar_n(hash_t *hash, const char *clave, size_t largo);
+void *hash_borrar_n(hash_t *hash, const char *clave, size_t largo);
+void *hash_obtener_n(const hash_t *hash, const char *clave, size_t largo);
+void **hash_buscar_ptr_n(const hash_t *hash, const char *clave, size_t largo);
+bool hash_pertenece_n(const hash_t *hash, const char *clave, size_t largo);
+
+/* Hash calculado por adelantado: hash_hash_clave devuelve el valor con
+ * que hash ubica clave, que depende solo de la función de hash y de la
+ * semilla. Las variantes _con_hash reciben ese valor en lugar de volver a
+ * calcularlo; sirven para repartir claves entre varias tablas creadas con
+ * la misma función y semilla (como hash_sharded) hasheando una sola vez.
+ * Por lo demás se comportan igual que las variantes _n.
+ * Pre: h es hash_hash_clave(hash, clave, largo)
+ */
+uint64_t hash_hash_clave(const hash_t *hash, const char *clave, size_t largo);
+bool hash_guardar_con_hash(hash_t *hash, const char *clave, size_t largo, uint64_t h, void *dato);
+void *hash_borrar_con_hash(hash_t *hash, const char *clave, size_t largo, uint64_t h);
+void *hash_obtener_con_hash(const hash_t *hash, const char *clave, size_t largo, uint64_t h);
+bool hash_pertenece_con_hash(const hash_t *hash, const char *clave, size_t largo, uint64_t h);
+
+/* Devuelve un puntero al dato asociado a clave, para leerlo o modificarlo
+ * con un solo sondeo. Si la clave no estaba, la inserta con dato NULL.
+ * Devuelve NULL si no pudo insertarla. El puntero deja de ser valido al
+ * guardar o borrar otro elemento.
+ * Pre: La estructura hash fue inicializada
+ * Post: clave pertenece al hash
+ */
+void **hash_obtener_o_insertar(hash_t *hash, const char *clave);
+
 /* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
  * NULL si el dato no estaba.
  * Pre: La estructura hash fue inicializada
@@ -39,16 +170,51 @@ void *hash_borrar(hash_t *hash, const char *clave);
  */
 void *hash_obtener(const hash_t *hash, const char *clave);
 
+/* Devuelve un puntero al dato asociado a clave, o NULL si la clave no
+ * pertenece al hash. El puntero deja de ser valido al guardar o borrar
+ * otro elemento.
+ * Pre: La estructura hash fue inicializada
+ */
+void **hash_buscar_ptr(const hash_t *hash, const char *clave);
+
 /* Determina si clave pertenece o no al hash.
  * Pre: La estructura hash fue inicializada
  */
 bool hash_pertenece(const hash_t *hash, const char *clave);
 
+/* Versiones en lote de hash_obtener y hash_pertenece: dejan en
+ * resultados[i] lo que devolveria la primitiva para claves[i]. Calculan
+ * primero los hashes de un tramo de claves y piden sus campos a memoria
+ * por adelantado, asi las esperas de las distintas claves se superponen.
+ * Pre: La estructura hash fue inicializada y resultados tiene lugar para
+ * n elementos.
+ */
+void hash_obtener_lote(const hash_t *hash, const char **claves, size_t n, void **resultados);
+void hash_pertenece_lote(const hash_t *hash, const char **claves, size_t n, bool *resultados);
+
 /* Devuelve la cantidad de elementos del hash.
  * Pre: La estructura hash fue inicializada
  */
 size_t hash_cantidad(const hash_t *hash);
 
+/* Congela el hash: lo pasa a un modo de solo lectura sin posiciones
+ * vacías, con una función de hash perfecta mínima (del estilo de CHD)
+ * que lleva cada clave a su campo en un solo acceso. Ocupa un campo por
+ * elemento más 2 bytes por elemento para la función, en lugar de entre
+ * 1/CARGA_MAX y el doble de campos por elemento.
+ * Después de congelarlo, hash_guardar y hash_obtener_o_insertar devuelven
+ * false y NULL, hash_borrar devuelve NULL y hash_reservar false; las
+ * búsquedas, el iterador y destruir funcionan como siempre.
+ * Devuelve false si no pudo congelarlo (falta de memoria, o una función
+ * de hash propia que da el mismo hash a dos claves); en ese caso el hash
+ * queda como estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_congelar(hash_t *hash);
+
+// Devuelve si el hash está congelado.
+bool hash_congelado(const hash_t *hash);
+
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
  * Pre: La estructura hash fue inicializada
@@ -64,15 +230,115 @@ hash_iter_t *hash_iter_crear(const hash_t *hash);
 // Avanza iterador
 bool hash_iter_avanzar(hash_iter_t *iter);
 
-// Devuelve clave actual, esa clave no se puede modificar ni liberar.
+// Devuelve clave actual, esa clave no se puede modificar ni liberar. Siempre
+// termina en '\0', aunque se haya guardado con una variante _n.
 const char *hash_iter_ver_actual(const hash_iter_t *iter);
 
+// Devuelve el dato actual, o NULL si terminó la iteración.
+void *hash_iter_ver_dato(const hash_iter_t *iter);
+
+// Deja en clave, largo y dato los del elemento actual (los punteros NULL se
+// ignoran). Devuelve false si terminó la iteración. No hace una búsqueda:
+// lee el campo en el que está el iterador.
+bool hash_iter_ver_par(const hash_iter_t *iter, const char **clave, size_t *largo, void **dato);
+
 // Comprueba si terminó la iteración
 bool hash_iter_al_final(const hash_iter_t *iter);
 
 // Destruye iterador
 void hash_iter_destruir(hash_iter_t* iter);
 
+/* Iterador interno: llama a visitar con cada elemento del hash, en una
+ * sola pasada por la tabla, hasta que visitar devuelva false. El hash no
+ * se puede modificar desde visitar.
+ * Solo con HASH_SONDEO_GRUPOS las posiciones vacías se saltean de a
+ * varias, leyendo los bytes de control; con sondeo lineal y Robin Hood
+ * (y en la tabla vieja de una migración) se revisa posición por posición,
+ * así que recorrer una tabla casi vacía cuesta lo mismo que una llena.
+ * Lo mismo vale para hash_iter_avanzar.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_para_cada(const hash_t *hash, bool visitar(const char *clave, size_t largo, void *dato, void *extra), void *extra);
+
+/* Iteración por rangos. Las posiciones de la tabla van de 0 a
+ * hash_posiciones(hash) - 1; un iterador de rango recorre solo los
+ * elementos de las posiciones [inicio, fin), así varios hilos pueden
+ * recorrer partes distintas del mismo hash a la vez (sin modificarlo).
+ */
+
+// Devuelve la cantidad de posiciones de la tabla.
+size_t hash_posiciones(const hash_t *hash);
+
+// Crea un iterador de las posiciones [inicio, fin). fin se recorta a
+// hash_posiciones(hash).
+hash_iter_t *hash_iter_crear_rango(const hash_t *hash, size_t inicio, size_t fin);
+
+/* Divide las posiciones de la tabla en k rangos consecutivos del mismo
+ * tamaño (a lo sumo uno por posición) y deja sus límites en limites, que
+ * tiene lugar para k + 1 valores: el rango i es [limites[i], limites[i+1]).
+ * Devuelve la cantidad de rangos. Las claves se reparten al azar en la
+ * tabla, así que cada rango tiene en promedio la misma cantidad.
+ */
+size_t hash_dividir_rangos(const hash_t *hash, size_t k, size_t *limites);
+
+/* Uso de memoria del hash, en bytes. Las claves de más de 15 bytes se
+ * guardan en una arena propia de la tabla; al borrarlas quedan como basura
+ * hasta que la arena se compacta.
+ */
+typedef struct hash_memoria{
+  size_t bytes_campos;        // arreglo de campos (y de control)
+  size_t bytes_claves;        // reservado por la arena de claves
+  size_t bytes_claves_usados; // entregado a claves, vivas o borradas
+  size_t bytes_basura;        // de claves borradas, se recupera al compactar
+  size_t bytes_total;         // todo lo anterior más la estructura
+} hash_memoria_t;
+
+void hash_memoria(const hash_t *hash, hash_memoria_t *memoria);
+
+/* Informe de sondeo: cuántas claves quedaron fuera de su posición inicial
+ * (colisiones) y el largo promedio y máximo del sondeo hasta cada clave.
+ * Pensado para diagnóstico y benchmarks; recorre toda la tabla.
+ */
+typedef struct hash_informe_sondeo{
+  size_t colisiones;
+  size_t largo_max;
+  double largo_promedio;
+} hash_informe_sondeo_t;
+
+void hash_informe_sondeo(const hash_t *hash, hash_informe_sondeo_t *informe);
+
+/* Estadísticas del hash para diagnóstico: carga, campos BORRADO, largos
+ * de sondeo, redimensiones, recompactaciones (limpiezas de los BORRADO
+ * sin cambiar la capacidad) y memoria. El histograma cuenta las claves
+ * por largo de sondeo en potencias de dos: histograma[0] las que están
+ * en su posición inicial (largo 1), histograma[i] las de largo entre 2^i
+ * y 2^(i+1)-1, y el último todas las de largo mayor.
+ * Los aciertos y fallos de búsqueda (obtener, pertenece, buscar_ptr y
+ * sus variantes en lote) solo se cuentan si hash.c se compila con
+ * -DHASH_ESTADISTICAS; si no, quedan en 0 y las búsquedas no pagan nada.
+ * Recorre toda la tabla.
+ */
+#define HASH_HISTOGRAMA 16
+
+typedef struct hash_estadisticas{
+  size_t cantidad;
+  size_t capacidad;               // posiciones, incluida la tabla vieja
+  double carga;                   // cantidad / capacidad
+  size_t borrados;                // campos BORRADO
+  double sondeo_promedio;
+  size_t sondeo_max;
+  size_t histograma[HASH_HISTOGRAMA];
+  size_t redimensiones;           // desde que se creó el hash
+  size_t recompactaciones;        // limpiezas de BORRADO sin redimensionar
+  size_t bytes_campos;            // como en hash_memoria
+  size_t bytes_claves;
+  bool contadores;                // si se compiló con HASH_ESTADISTICAS
+  uint64_t aciertos;
+  uint64_t fallos;
+} hash_estadisticas_t;
+
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas);
+
 void imprimir(const hash_t* hash);
 
 #endif // HASH_H
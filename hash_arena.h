@@ -0,0 +1,133 @@
+#ifndef HASH_ARENA_H
+#define HASH_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "hash_interno.h"
+
+/* Arena de claves largas, compartida por hash_t y hash_set_t. No es parte
+ * de la interfaz: solo lo incluyen hash.c y hash_set.c.
+ */
+
+// Las claves largas se guardan en bloques de la arena de la tabla. Cada
+// bloque nuevo duplica al anterior, entre ARENA_BLOQUE_MIN y ARENA_BLOQUE_MAX.
+#define ARENA_BLOQUE_MIN 4096
+#define ARENA_BLOQUE_MAX (1 << 20)
+// Se compacta la arena cuando las claves borradas superan esta fraccion
+// de lo usado (y al menos un bloque minimo).
+#define ARENA_BASURA_MAX 0.5
+
+// Bloque de la arena: se entrega de adelante hacia atras y no se libera
+// por partes.
+typedef struct arena_bloque{
+  struct arena_bloque* sig;
+  size_t tam;
+  size_t usado;
+  uint64_t datos[];    // alineado para clave_larga_t
+}arena_bloque_t;
+
+typedef struct arena{
+  const hash_allocator_t* allocator;
+  arena_bloque_t* bloques; // el primero es en el que se sigue pidiendo
+  size_t reservado;        // suma de los tam de los bloques
+  size_t usado;            // bytes entregados, incluidas las claves borradas
+  size_t basura;           // bytes de claves borradas
+}arena_t;
+
+/* La arena guarda los bytes de las claves largas. Borrar una clave solo
+ * suma a la basura; cuando hay demasiada, cada tabla copia sus claves
+ * vivas a una arena nueva (ver arena_compactar_iniciar). Redimensionar mueve los campos pero no las
+ * claves, y destruir libera todo de a bloques.
+ */
+
+static inline void arena_crear(arena_t* arena, const hash_allocator_t* allocator){
+  arena->allocator = allocator;
+  arena->bloques = NULL;
+  arena->reservado = 0;
+  arena->usado = 0;
+  arena->basura = 0;
+}
+
+static inline size_t arena_alinear(size_t tam){
+  return (tam + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+/* Agrega a la arena un bloque de al menos tam bytes. */
+static inline bool arena_agregar_bloque(arena_t* arena, size_t tam){
+  size_t tam_bloque = arena->bloques ? arena->bloques->tam * 2 : ARENA_BLOQUE_MIN;
+  if (tam_bloque > ARENA_BLOQUE_MAX) tam_bloque = ARENA_BLOQUE_MAX;
+  if (tam_bloque < tam) tam_bloque = tam;
+  arena_bloque_t* bloque = arena->allocator->pedir(arena->allocator->contexto, sizeof(arena_bloque_t) + tam_bloque);
+  if (bloque == NULL) return false;
+  bloque->tam = tam_bloque;
+  bloque->usado = 0;
+  bloque->sig = arena->bloques;
+  arena->bloques = bloque;
+  arena->reservado += tam_bloque;
+  return true;
+}
+
+static inline void* arena_pedir(arena_t* arena, size_t tam){
+  tam = arena_alinear(tam);
+  arena_bloque_t* bloque = arena->bloques;
+  if (bloque == NULL || bloque->tam - bloque->usado < tam){
+    if (!arena_agregar_bloque(arena, tam)) return NULL;
+    bloque = arena->bloques;
+  }
+  void* memoria = (char*)bloque->datos + bloque->usado;
+  bloque->usado += tam;
+  arena->usado += tam;
+  return memoria;
+}
+
+static inline void arena_devolver(arena_t* arena, size_t tam){
+  arena->basura += arena_alinear(tam);
+}
+
+/* Determina si conviene copiar las claves vivas a una arena nueva. */
+static inline bool arena_hay_que_compactar(const arena_t* arena){
+  return arena->basura >= ARENA_BLOQUE_MIN && (double)arena->basura > ARENA_BASURA_MAX * (double)arena->usado;
+}
+
+static inline void arena_destruir(arena_t* arena){
+  arena_bloque_t* bloque = arena->bloques;
+  while (bloque != NULL){
+    arena_bloque_t* sig = bloque->sig;
+    arena->allocator->liberar(arena->allocator->contexto, bloque, sizeof(arena_bloque_t) + bloque->tam);
+    bloque = sig;
+  }
+  arena_crear(arena, arena->allocator);
+}
+
+/* Para compactar, cada tabla crea con arena_compactar_iniciar una arena
+ * nueva de un solo bloque, donde entran las claves vivas; muda a ella cada
+ * clave larga con arena_mudar y termina con arena_compactar_terminar, que
+ * libera la arena vieja. Si no hay memoria para el bloque, iniciar devuelve
+ * false y la arena queda como estaba.
+ */
+
+static inline bool arena_compactar_iniciar(const arena_t* arena, arena_t* nueva){
+  arena_crear(nueva, arena->allocator);
+  size_t vivas = arena->usado - arena->basura;
+  return vivas == 0 || arena_agregar_bloque(nueva, vivas);
+}
+
+/* Copia los tam bytes de clave a la arena nueva y devuelve la copia.
+ * Pre: nueva viene de arena_compactar_iniciar.
+ */
+static inline void* arena_mudar(arena_t* nueva, const void* clave, size_t tam){
+  void* copia = arena_pedir(nueva, tam);
+  memcpy(copia, clave, tam);
+  return copia;
+}
+
+static inline void arena_compactar_terminar(arena_t* arena, arena_t* nueva){
+  arena_destruir(arena);
+  *arena = *nueva;
+}
+
+#endif // HASH_ARENA_H
@@ -0,0 +1,240 @@
+#ifndef HASH_GENERICO_H
+#define HASH_GENERICO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "hash_interno.h"
+
+/* Hash con claves de tamaño fijo (enteros, structs), especializado en
+ * tiempo de compilación:
+ *
+ *     HASH_DEFINIR(nombre, tipo_clave, tipo_valor, fhash, igual)
+ *
+ * define el tipo nombre_t y sus primitivas, todas static inline. Claves y
+ * valores se guardan por valor dentro de la tabla: guardar no pide memoria
+ * por clave, y buscar compara con igual en lugar de strcmp.
+ *  - fhash: uint64_t fhash(tipo_clave clave, uint64_t semilla)
+ *  - igual: bool igual(tipo_clave a, tipo_clave b)
+ * Pueden ser funciones o macros con argumentos. Para claves enteras están
+ * hash_entero y hash_entero_igual.
+ *
+ * La tabla es de sondeo lineal y sigue la politica de hash_t con sus
+ * mismas constantes (hash_interno.h): crece a HASH_CARGA_MAX contando los
+ * BORRADO, los limpia sin crecer cuando son al menos HASH_BORRADOS_MAX de
+ * la capacidad, se achica a HASH_CARGA_MIN y nunca baja de
+ * HASH_TAM_INICIAL. Cada tabla tiene su propia semilla.
+ *
+ * Primitivas que define:
+ *   nombre_t *nombre_crear(void);
+ *   nombre_t *nombre_crear_con_opciones(const hash_opciones_t *opciones);
+ *   bool nombre_guardar(nombre_t *hash, tipo_clave clave, tipo_valor valor);
+ *   tipo_valor *nombre_obtener(const nombre_t *hash, tipo_clave clave);
+ *   bool nombre_pertenece(const nombre_t *hash, tipo_clave clave);
+ *   bool nombre_borrar(nombre_t *hash, tipo_clave clave, tipo_valor *valor);
+ *   size_t nombre_cantidad(const nombre_t *hash);
+ *   void nombre_para_cada(const nombre_t *hash, bool visitar(tipo_clave clave, tipo_valor *valor, void *extra), void *extra);
+ *   void nombre_destruir(nombre_t *hash);
+ * obtener devuelve un puntero al valor dentro de la tabla, o NULL si la
+ * clave no está; deja de ser válido al guardar o borrar. borrar devuelve
+ * false si la clave no estaba y, si valor no es NULL, deja ahí el valor
+ * borrado. guardar devuelve false si no hay memoria para crecer.
+ * crear_con_opciones usa de las opciones de hash_crear_con_opciones (que
+ * pueden ser NULL) el allocator, la semilla y la capacidad; fhash reemplaza
+ * a la función de hash, y el sondeo es siempre lineal.
+ */
+
+#define HASH_GENERICO_VACIO 0
+#define HASH_GENERICO_OCUPADO 1
+#define HASH_GENERICO_BORRADO 2
+
+/* Mezcla los 64 bits de clave con la semilla (finalizador de murmur3):
+ * pocas instrucciones y cada bit de la clave cambia los bits altos.
+ */
+static inline uint64_t hash_entero(uint64_t clave, uint64_t semilla){
+  uint64_t x = clave ^ semilla;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+static inline bool hash_entero_igual(uint64_t a, uint64_t b){
+  return a == b;
+}
+
+#define HASH_DEFINIR(nombre, tipo_clave, tipo_valor, fhash, igual) \
+\
+typedef struct nombre##_campo{ \
+  tipo_clave clave; \
+  tipo_valor valor; \
+}nombre##_campo_t; \
+\
+typedef struct nombre{ \
+  hash_allocator_t allocator; \
+  nombre##_campo_t* campos; \
+  uint8_t* estados;        /* uno por campo, aparte para no agregar relleno */ \
+  size_t capacidad;        /* siempre potencia de dos */ \
+  size_t mascara; \
+  unsigned desplazamiento; /* 64 - log2(capacidad) */ \
+  size_t cantidad; \
+  size_t borrados; \
+  size_t minima;           /* capacidad por debajo de la cual no se achica */ \
+  uint64_t semilla; \
+}nombre##_t; \
+\
+static inline size_t nombre##_posicion(const nombre##_t* hash, tipo_clave clave){ \
+  return (size_t)((fhash(clave, hash->semilla) * HASH_FIBONACCI) >> hash->desplazamiento); \
+} \
+\
+/* Devuelve la posicion de clave, o la primera libre de su sondeo si no \
+ * esta. Siempre hay algun VACIO, asi que el sondeo termina. */ \
+static inline size_t nombre##_ubicar(const nombre##_t* hash, tipo_clave clave, bool* encontrado){ \
+  size_t pos = nombre##_posicion(hash, clave); \
+  size_t libre = SIZE_MAX; \
+  *encontrado = false; \
+  while (hash->estados[pos] != HASH_GENERICO_VACIO){ \
+    if (hash->estados[pos] == HASH_GENERICO_BORRADO){ \
+      if (libre == SIZE_MAX) libre = pos; \
+    } else if (igual(hash->campos[pos].clave, clave)){ \
+      *encontrado = true; \
+      return pos; \
+    } \
+    pos = (pos + 1) & hash->mascara; \
+  } \
+  return libre != SIZE_MAX ? libre : pos; \
+} \
+\
+/* Pasa los campos a una tabla nueva de tam posiciones, sin BORRADO. */ \
+static inline bool nombre##_redimensionar(nombre##_t* hash, size_t tam){ \
+  const hash_allocator_t* allocator = &hash->allocator; \
+  nombre##_campo_t* campos = allocator->pedir(allocator->contexto, tam * sizeof(nombre##_campo_t)); \
+  uint8_t* estados = allocator->pedir(allocator->contexto, tam * sizeof(uint8_t)); \
+  if (campos == NULL || estados == NULL){ \
+    if (campos != NULL) allocator->liberar(allocator->contexto, campos, tam * sizeof(nombre##_campo_t)); \
+    if (estados != NULL) allocator->liberar(allocator->contexto, estados, tam * sizeof(uint8_t)); \
+    return false; \
+  } \
+  memset(estados, HASH_GENERICO_VACIO, tam * sizeof(uint8_t)); \
+  nombre##_t viejo = *hash; \
+  hash->campos = campos; \
+  hash->estados = estados; \
+  hash->capacidad = tam; \
+  hash->mascara = tam - 1; \
+  hash->desplazamiento = 64; \
+  while (tam > 1){ \
+    hash->desplazamiento--; \
+    tam >>= 1; \
+  } \
+  hash->borrados = 0; \
+  for (size_t i=0; i<viejo.capacidad; i++){ \
+    if (viejo.estados[i] != HASH_GENERICO_OCUPADO) continue; \
+    size_t pos = nombre##_posicion(hash, viejo.campos[i].clave); \
+    while (estados[pos] != HASH_GENERICO_VACIO) pos = (pos + 1) & hash->mascara; \
+    estados[pos] = HASH_GENERICO_OCUPADO; \
+    campos[pos] = viejo.campos[i]; \
+  } \
+  if (viejo.capacidad > 0){ \
+    allocator->liberar(allocator->contexto, viejo.campos, viejo.capacidad * sizeof(nombre##_campo_t)); \
+    allocator->liberar(allocator->contexto, viejo.estados, viejo.capacidad * sizeof(uint8_t)); \
+  } \
+  return true; \
+} \
+\
+static inline nombre##_t* nombre##_crear_con_opciones(const hash_opciones_t* opciones){ \
+  hash_opciones_t por_omision = {0}; \
+  if (opciones == NULL) opciones = &por_omision; \
+  const hash_allocator_t* allocator = opciones->allocator ? opciones->allocator : &HASH_ALLOCATOR_MALLOC; \
+  nombre##_t* hash = allocator->pedir(allocator->contexto, sizeof(nombre##_t)); \
+  if (hash == NULL) return NULL; \
+  hash->allocator = *allocator; \
+  hash->campos = NULL; \
+  hash->estados = NULL; \
+  hash->capacidad = 0; \
+  hash->cantidad = 0; \
+  hash->minima = hash_capacidad_inicial(); \
+  if (opciones->capacidad > 0 && hash_capacidad_para(opciones->capacidad) > hash->minima){ \
+    hash->minima = hash_capacidad_para(opciones->capacidad); \
+  } \
+  hash->semilla = opciones->semilla != 0 ? opciones->semilla : hash_semilla_aleatoria(hash); \
+  if (!nombre##_redimensionar(hash, hash->minima)){ \
+    allocator->liberar(allocator->contexto, hash, sizeof(nombre##_t)); \
+    return NULL; \
+  } \
+  return hash; \
+} \
+\
+static inline nombre##_t* nombre##_crear(void){ \
+  return nombre##_crear_con_opciones(NULL); \
+} \
+\
+static inline bool nombre##_guardar(nombre##_t* hash, tipo_clave clave, tipo_valor valor){ \
+  bool encontrado; \
+  size_t pos = nombre##_ubicar(hash, clave, &encontrado); \
+  /* La carga de hash_t contando la clave nueva: siempre queda un VACIO */ \
+  if (!encontrado && (double)(hash->cantidad + hash->borrados + 1) > HASH_CARGA_MAX * (double)hash->capacidad){ \
+    /* Con muchos BORRADO alcanza con limpiarlos */ \
+    size_t tam = (double)hash->borrados >= HASH_BORRADOS_MAX * (double)hash->capacidad ? hash->capacidad : hash->capacidad * 2; \
+    if (!nombre##_redimensionar(hash, tam)) return false; \
+    pos = nombre##_ubicar(hash, clave, &encontrado); \
+  } \
+  if (!encontrado){ \
+    if (hash->estados[pos] == HASH_GENERICO_BORRADO) hash->borrados--; \
+    hash->estados[pos] = HASH_GENERICO_OCUPADO; \
+    hash->campos[pos].clave = clave; \
+    hash->cantidad++; \
+  } \
+  hash->campos[pos].valor = valor; \
+  return true; \
+} \
+\
+static inline tipo_valor* nombre##_obtener(const nombre##_t* hash, tipo_clave clave){ \
+  bool encontrado; \
+  size_t pos = nombre##_ubicar(hash, clave, &encontrado); \
+  return encontrado ? &hash->campos[pos].valor : NULL; \
+} \
+\
+static inline bool nombre##_pertenece(const nombre##_t* hash, tipo_clave clave){ \
+  bool encontrado; \
+  nombre##_ubicar(hash, clave, &encontrado); \
+  return encontrado; \
+} \
+\
+static inline bool nombre##_borrar(nombre##_t* hash, tipo_clave clave, tipo_valor* valor){ \
+  bool encontrado; \
+  size_t pos = nombre##_ubicar(hash, clave, &encontrado); \
+  if (!encontrado) return false; \
+  if (valor != NULL) *valor = hash->campos[pos].valor; \
+  hash->estados[pos] = HASH_GENERICO_BORRADO; \
+  hash->borrados++; \
+  hash->cantidad--; \
+  if ((double)hash->cantidad / (double)hash->capacidad <= HASH_CARGA_MIN && hash->capacidad / 2 >= hash->minima){ \
+    nombre##_redimensionar(hash, hash->capacidad / 2); \
+  } \
+  return true; \
+} \
+\
+static inline size_t nombre##_cantidad(const nombre##_t* hash){ \
+  return hash->cantidad; \
+} \
+\
+static inline void nombre##_para_cada(const nombre##_t* hash, bool visitar(tipo_clave clave, tipo_valor* valor, void* extra), void* extra){ \
+  for (size_t i=0; i<hash->capacidad; i++){ \
+    if (hash->estados[i] != HASH_GENERICO_OCUPADO) continue; \
+    if (!visitar(hash->campos[i].clave, &hash->campos[i].valor, extra)) return; \
+  } \
+} \
+\
+static inline void nombre##_destruir(nombre##_t* hash){ \
+  hash_allocator_t allocator = hash->allocator; \
+  allocator.liberar(allocator.contexto, hash->campos, hash->capacidad * sizeof(nombre##_campo_t)); \
+  allocator.liberar(allocator.contexto, hash->estados, hash->capacidad * sizeof(uint8_t)); \
+  allocator.liberar(allocator.contexto, hash, sizeof(nombre##_t)); \
+}
+
+#endif // HASH_GENERICO_H
@@ -0,0 +1,126 @@
+#ifndef HASH_INTERNO_H
+#define HASH_INTERNO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "hash.h"
+
+/* Constantes y allocator por omision que comparten las tablas de la
+ * biblioteca (hash_t, hash_set_t y las que genera HASH_DEFINIR), para que
+ * todas crezcan y se achiquen con las mismas cargas. No es parte de la
+ * interfaz; hash_generico.h lo incluye porque sus primitivas son inline,
+ * asi que todo nombre de aca lleva el prefijo HASH_ o hash_.
+ */
+
+// Se pueden redefinir al compilar (-DHASH_TAM_INICIAL=...). La capacidad
+// real es siempre una potencia de dos: HASH_TAM_INICIAL se redondea hacia
+// arriba.
+#ifndef HASH_TAM_INICIAL
+#define HASH_TAM_INICIAL 32
+#endif
+#ifndef HASH_CARGA_MAX
+#define HASH_CARGA_MAX 0.7
+#endif
+#ifndef HASH_CARGA_MIN
+#define HASH_CARGA_MIN 0.3
+#endif
+// Al llegar a HASH_CARGA_MAX contando los BORRADO, si estos son al menos
+// esta fraccion de la capacidad se los limpia sin cambiar la capacidad.
+// Con a lo sumo HASH_CARGA_MAX - 2*HASH_CARGA_MIN la tabla duplicada no
+// queda para achicarse en el proximo borrado.
+#ifndef HASH_BORRADOS_MAX
+#define HASH_BORRADOS_MAX 0.1
+#endif
+// 2^64 / phi: la multiplicacion de Fibonacci reparte en los bits altos
+// incluso hashes con poca entropia en los bajos.
+#define HASH_FIBONACCI 11400714819323198485ull
+// Las claves de hasta HASH_CLAVE_CORTA bytes se guardan dentro del campo.
+#define HASH_CLAVE_CORTA 15
+
+/* Menor potencia de dos mayor o igual a n (y al menos 2). */
+static inline size_t hash_potencia_de_dos(size_t n){
+  size_t tam = 2;
+  while (tam < n) tam <<= 1;
+  return tam;
+}
+
+/* HASH_TAM_INICIAL redondeado a potencia de dos. */
+static inline size_t hash_capacidad_inicial(void){
+  return hash_potencia_de_dos(HASH_TAM_INICIAL);
+}
+
+/* Menor capacidad en la que entran n elementos sin llegar a
+ * HASH_CARGA_MAX.
+ */
+static inline size_t hash_capacidad_para(size_t n){
+  return hash_potencia_de_dos((size_t)((double)n / HASH_CARGA_MAX) + 1);
+}
+
+/* Define la busqueda por sondeo lineal de una tabla con campos de tipo
+ * tipo_campo en tabla->arreglo, que tengan hash, largo y estado:
+ *   static size_t nombre(const tipo_tabla* tabla, const char* clave, size_t largo, uint64_t h, bool* encontrado);
+ * Recorre una sola vez el sondeo de clave, cuyo hash es h. Si la encuentra
+ * devuelve su posicion y deja *encontrado en true. Si no, devuelve donde
+ * corresponde insertarla: el primer campo en estado borrado del camino o
+ * el vacio que lo termino, o (size_t)-1 si no hay ninguno. clave_igual
+ * compara el campo con la clave, mirando primero el hash y el largo.
+ */
+#define HASH_DEFINIR_UBICAR_LINEAL(nombre, tipo_tabla, tipo_campo, arreglo, vacio, borrado, clave_igual) \
+static size_t nombre(const tipo_tabla* tabla, const char* clave, size_t largo, uint64_t h, bool* encontrado){ \
+  size_t pos = (size_t)((h * HASH_FIBONACCI) >> tabla->desplazamiento); \
+  size_t pos_libre = (size_t)-1; \
+  *encontrado = false; \
+  for (size_t i=0; i<tabla->capacidad; i++){ \
+    const tipo_campo* campo = &tabla->arreglo[pos]; \
+    if (campo->estado == (vacio)) return pos_libre != (size_t)-1 ? pos_libre : pos; \
+    if (campo->estado == (borrado)){ \
+      if (pos_libre == (size_t)-1) pos_libre = pos; \
+    } else if (clave_igual(campo, h, clave, largo)){ \
+      *encontrado = true; \
+      return pos; \
+    } \
+    pos = (pos + 1) & tabla->mascara; \
+  } \
+  return pos_libre; \
+}
+
+// Definido en hash.c: una sola cuenta para todas las tablas del programa.
+extern uint64_t hash_semillas_creadas;
+
+/* Semilla distinta para cada tabla, asi dos tablas (o dos ejecuciones) no
+ * comparten colisiones. No es criptografica: solo busca que las claves
+ * elegidas por un adversario no colisionen de forma predecible. Dos tablas
+ * creadas en el mismo tick en la misma direccion se distinguen por el
+ * contador.
+ */
+static inline uint64_t hash_semilla_aleatoria(const void* direccion){
+  // Se pueden crear tablas desde varios hilos a la vez: el contador se
+  // incrementa de forma atomica, o no se usa si no hay como.
+#if defined(__GNUC__)
+  uint64_t n = __atomic_add_fetch(&hash_semillas_creadas, 1, __ATOMIC_RELAXED);
+#else
+  uint64_t n = 0;
+#endif
+  uint64_t datos[4] = {(uint64_t)time(NULL), (uint64_t)clock(), (uint64_t)(uintptr_t)direccion, n};
+  return fhash_rapida(datos, sizeof(datos), 0);
+}
+
+/* Allocator por omision: malloc y free. */
+
+static inline void* hash_malloc_pedir(void* contexto, size_t tam){
+  (void)contexto;
+  return malloc(tam);
+}
+
+static inline void hash_malloc_liberar(void* contexto, void* ptr, size_t tam){
+  (void)contexto;
+  (void)tam;
+  free(ptr);
+}
+
+static const hash_allocator_t HASH_ALLOCATOR_MALLOC = {hash_malloc_pedir, hash_malloc_liberar, NULL};
+
+#endif // HASH_INTERNO_H
@@ -0,0 +1,128 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "hash_pool.h"
+
+#define TAM_BLOQUE_POR_OMISION (1 << 20)
+// Los pedidos se redondean a 2^clase bytes, con 2^CLASE_MIN como minimo
+// para poder guardar el puntero al siguiente libre.
+#define CLASE_MIN 4
+#define CLASES 64
+/* ******************************************************************
+ *                           STRUCTS
+ * *****************************************************************/
+
+typedef struct pool_bloque{
+  struct pool_bloque* sig;
+  size_t tam;
+  size_t usado;
+  uint64_t datos[];
+}pool_bloque_t;
+
+typedef struct pool_libre{
+  struct pool_libre* sig;
+}pool_libre_t;
+
+struct hash_pool{
+  pool_bloque_t* bloques;      // el primero es en el que se sigue pidiendo
+  size_t tam_bloque;
+  size_t reservado;
+  pool_libre_t* libres[CLASES]; // devueltos, por clase
+};
+
+/* ******************************************************************
+ *                      FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static unsigned pool_clase(size_t tam){
+  unsigned clase = CLASE_MIN;
+  while (((size_t)1 << clase) < tam) clase++;
+  return clase;
+}
+
+/* Agrega un bloque de tam bytes al pool. Si principal es false el bloque
+ * queda detras del actual, asi no se pierde lo que falta usar de este.
+ */
+static pool_bloque_t* pool_agregar_bloque(hash_pool_t* pool, size_t tam, bool principal){
+  pool_bloque_t* bloque = malloc(sizeof(pool_bloque_t) + tam);
+  if (bloque == NULL) return NULL;
+  bloque->tam = tam;
+  bloque->usado = 0;
+  if (principal || pool->bloques == NULL){
+    bloque->sig = pool->bloques;
+    pool->bloques = bloque;
+  } else {
+    bloque->sig = pool->bloques->sig;
+    pool->bloques->sig = bloque;
+  }
+  pool->reservado += tam;
+  return bloque;
+}
+
+static void* pool_pedir(void* contexto, size_t tam){
+  hash_pool_t* pool = contexto;
+  unsigned clase = pool_clase(tam);
+  if (clase >= CLASES) return NULL;
+  if (pool->libres[clase] != NULL){
+    pool_libre_t* libre = pool->libres[clase];
+    pool->libres[clase] = libre->sig;
+    return libre;
+  }
+  size_t tam_clase = (size_t)1 << clase;
+  if (tam_clase > pool->tam_bloque / 4){
+    pool_bloque_t* propio = pool_agregar_bloque(pool, tam_clase, false);
+    if (propio == NULL) return NULL;
+    propio->usado = tam_clase;
+    return propio->datos;
+  }
+  pool_bloque_t* bloque = pool->bloques;
+  if (bloque == NULL || bloque->tam - bloque->usado < tam_clase){
+    bloque = pool_agregar_bloque(pool, pool->tam_bloque, true);
+    if (bloque == NULL) return NULL;
+  }
+  void* memoria = (char*)bloque->datos + bloque->usado;
+  bloque->usado += tam_clase;
+  return memoria;
+}
+
+static void pool_liberar(void* contexto, void* ptr, size_t tam){
+  hash_pool_t* pool = contexto;
+  unsigned clase = pool_clase(tam);
+  pool_libre_t* libre = ptr;
+  libre->sig = pool->libres[clase];
+  pool->libres[clase] = libre;
+}
+
+/* ******************************************************************
+ *                       PRIMITIVAS DEL POOL
+ * *****************************************************************/
+
+hash_pool_t *hash_pool_crear(size_t tam_bloque){
+  hash_pool_t* pool = malloc(sizeof(hash_pool_t));
+  if (pool == NULL) return NULL;
+  pool->bloques = NULL;
+  pool->tam_bloque = tam_bloque != 0 ? tam_bloque : TAM_BLOQUE_POR_OMISION;
+  pool->reservado = 0;
+  for (size_t i=0; i<CLASES; i++) pool->libres[i] = NULL;
+  return pool;
+}
+
+hash_allocator_t hash_pool_allocator(hash_pool_t *pool){
+  hash_allocator_t allocator = {pool_pedir, pool_liberar, pool};
+  return allocator;
+}
+
+size_t hash_pool_reservado(const hash_pool_t *pool){
+  return pool->reservado;
+}
+
+void hash_pool_destruir(hash_pool_t *pool){
+  pool_bloque_t* bloque = pool->bloques;
+  while (bloque != NULL){
+    pool_bloque_t* sig = bloque->sig;
+    free(bloque);
+    bloque = sig;
+  }
+  free(pool);
+}
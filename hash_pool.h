@@ -0,0 +1,34 @@
+#ifndef HASH_POOL_H
+#define HASH_POOL_H
+
+#include <stddef.h>
+#include "hash.h"
+
+/* Pool de memoria para usar como allocator de uno o más hashes. Entrega
+ * memoria avanzando dentro de bloques grandes, y lo que se le devuelve lo
+ * reutiliza para pedidos del mismo tamaño (redondeado a potencia de dos).
+ * Nada vuelve al sistema hasta destruir el pool.
+ */
+struct hash_pool;
+typedef struct hash_pool hash_pool_t;
+
+/* Crea el pool. Pide memoria al sistema en bloques de tam_bloque bytes
+ * (0 usa 1 MiB); los pedidos grandes reciben un bloque propio.
+ */
+hash_pool_t *hash_pool_crear(size_t tam_bloque);
+
+/* Devuelve un allocator que pide memoria a pool, para pasar a
+ * hash_crear_con_allocator.
+ * Pre: el pool fue creado.
+ */
+hash_allocator_t hash_pool_allocator(hash_pool_t *pool);
+
+/* Devuelve los bytes que el pool pidió al sistema. */
+size_t hash_pool_reservado(const hash_pool_t *pool);
+
+/* Libera toda la memoria del pool de una vez.
+ * Pre: ningún hash sigue usando el pool.
+ */
+void hash_pool_destruir(hash_pool_t *pool);
+
+#endif // HASH_POOL_H
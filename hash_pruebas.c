@@ -6,8 +6,14 @@
  */
 
 #include "hash.h"
+#include "hash_generico.h"
+#include "hash_pool.h"
+#include "hash_set.h"
+#include "hash_sharded.h"
+#include "hash_snapshot.h"
 #include "testing.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,6 +24,26 @@
  *                        PRUEBAS UNITARIAS
  * *****************************************************************/
 
+/* Instancias del hash generico: claves enteras y claves struct */
+HASH_DEFINIR(hash_enteros, uint64_t, uint64_t, hash_entero, hash_entero_igual)
+
+typedef struct punto {
+    int32_t x;
+    int32_t y;
+} punto_t;
+
+static uint64_t punto_hash(punto_t punto, uint64_t semilla)
+{
+    return hash_entero((uint64_t) (uint32_t) punto.x << 32 | (uint32_t) punto.y, semilla);
+}
+
+static bool punto_igual(punto_t a, punto_t b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+HASH_DEFINIR(hash_puntos, punto_t, const char*, punto_hash, punto_igual)
+
 static void prueba_crear_hash_vacio()
 {
     hash_t* hash = hash_crear(NULL);
@@ -205,6 +231,129 @@ static void prueba_hash_valor_null()
     hash_destruir(hash);
 }
 
+static void prueba_hash_obtener_o_insertar()
+{
+    hash_t* hash = hash_crear(NULL);
+
+    char *palabras[] = {"perro", "gato", "perro", "vaca", "perro", "gato"};
+    size_t cantidades[] = {0, 0, 0};
+
+    /* Cuenta apariciones tocando la tabla una sola vez por palabra */
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(palabras) / sizeof(char *); i++) {
+        void **dato = hash_obtener_o_insertar(hash, palabras[i]);
+        if (!dato) {
+            ok = false;
+            break;
+        }
+        if (!*dato) *dato = &cantidades[hash_cantidad(hash) - 1];
+        (*(size_t *) *dato)++;
+    }
+    print_test("Prueba hash obtener o insertar varias veces", ok);
+    print_test("Prueba hash la cantidad de elementos es 3", hash_cantidad(hash) == 3);
+    print_test("Prueba hash perro aparece 3 veces", *(size_t *) hash_obtener(hash, "perro") == 3);
+    print_test("Prueba hash gato aparece 2 veces", *(size_t *) hash_obtener(hash, "gato") == 2);
+    print_test("Prueba hash vaca aparece 1 vez", *(size_t *) hash_obtener(hash, "vaca") == 1);
+
+    void **dato = hash_buscar_ptr(hash, "vaca");
+    print_test("Prueba hash buscar ptr clave existente", dato && *dato == &cantidades[2]);
+    *dato = NULL;
+    print_test("Prueba hash modificar dato por puntero", hash_obtener(hash, "vaca") == NULL);
+    print_test("Prueba hash buscar ptr clave inexistente es NULL", !hash_buscar_ptr(hash, "oveja"));
+    print_test("Prueba hash buscar ptr no inserta", hash_cantidad(hash) == 3);
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_claves_n()
+{
+    hash_t* hash = hash_crear(NULL);
+
+    /* Claves dentro de un buffer sin '\0' entre ellas */
+    const char *buffer = "perrogatovaca";
+    char *valor1 = "guau", *valor2 = "miau", *valor3 = "mu";
+    print_test("Prueba hash guardar_n perro", hash_guardar_n(hash, buffer, 5, valor1));
+    print_test("Prueba hash guardar_n gato", hash_guardar_n(hash, buffer + 5, 4, valor2));
+    print_test("Prueba hash obtener perro sin _n", hash_obtener(hash, "perro") == valor1);
+    print_test("Prueba hash obtener_n gato", hash_obtener_n(hash, buffer + 5, 4) == valor2);
+    print_test("Prueba hash pertenece_n prefijo, es false", !hash_pertenece_n(hash, buffer, 4));
+    print_test("Prueba hash pertenece_n vaca, es false", !hash_pertenece_n(hash, buffer + 9, 4));
+
+    /* Una clave con '\0' en el medio es distinta de su prefijo */
+    const char con_cero[] = {'a', '\0', 'b'};
+    print_test("Prueba hash guardar_n clave con cero", hash_guardar_n(hash, con_cero, 3, valor3));
+    print_test("Prueba hash obtener_n clave con cero", hash_obtener_n(hash, con_cero, 3) == valor3);
+    print_test("Prueba hash pertenece clave \"a\", es false", !hash_pertenece(hash, "a"));
+    print_test("Prueba hash borrar_n clave con cero", hash_borrar_n(hash, con_cero, 3) == valor3);
+
+    /* Claves en el limite entre cortas y largas */
+    char *corta = "123456789012345", *larga = "1234567890123456";
+    char *muy_larga = "una clave bastante mas larga que cualquier identificador corto";
+    print_test("Prueba hash guardar clave de 15 bytes", hash_guardar(hash, corta, corta));
+    print_test("Prueba hash guardar clave de 16 bytes", hash_guardar(hash, larga, larga));
+    print_test("Prueba hash guardar clave larga", hash_guardar(hash, muy_larga, muy_larga));
+    print_test("Prueba hash obtener clave de 15 bytes", hash_obtener(hash, corta) == corta);
+    print_test("Prueba hash obtener clave de 16 bytes", hash_obtener(hash, larga) == larga);
+    print_test("Prueba hash obtener clave larga", hash_obtener(hash, muy_larga) == muy_larga);
+    print_test("Prueba hash la cantidad de elementos es 5", hash_cantidad(hash) == 5);
+
+    /* El iterador devuelve cada clave terminada en '\0' */
+    bool ok = true;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        const char *clave = hash_iter_ver_actual(iter);
+        ok &= hash_obtener(hash, clave) != NULL;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash iterar claves guardadas con _n", ok);
+
+    print_test("Prueba hash borrar clave larga", hash_borrar(hash, muy_larga) == muy_larga);
+    print_test("Prueba hash pertenece clave larga, es false", !hash_pertenece(hash, muy_larga));
+    hash_destruir(hash);
+}
+
+static void prueba_hash_claves_largas(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+    hash_memoria_t antes, despues;
+    char clave[64];
+
+    /* Inserta 'largo' claves que no entran en el campo */
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "una clave bastante larga numero %08zu", i);
+        ok &= hash_guardar(hash, clave, hash);
+    }
+    hash_memoria(hash, &antes);
+    print_test("Prueba hash guardar claves largas", ok);
+    print_test("Prueba hash las claves largas usan la arena", antes.bytes_claves_usados >= largo * strlen(clave));
+    print_test("Prueba hash sin basura antes de borrar", antes.bytes_basura == 0);
+
+    /* Borra nueve de cada diez: la arena se compacta sola */
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        if (i % 10 == 0) continue;
+        sprintf(clave, "una clave bastante larga numero %08zu", i);
+        ok &= hash_borrar(hash, clave) == hash;
+    }
+    hash_memoria(hash, &despues);
+    print_test("Prueba hash borrar claves largas", ok);
+    print_test("Prueba hash la basura no supera la mitad de lo usado",
+               despues.bytes_basura * 2 <= despues.bytes_claves_usados);
+    print_test("Prueba hash la arena se achico", despues.bytes_claves < antes.bytes_claves);
+
+    /* Las claves que quedaron siguen intactas despues de compactar */
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "una clave bastante larga numero %08zu", i);
+        ok &= hash_pertenece(hash, clave) == (i % 10 == 0);
+    }
+    print_test("Prueba hash buscar claves largas despues de compactar", ok);
+    print_test("Prueba hash la cantidad de elementos es correcta", hash_cantidad(hash) == (largo + 9) / 10);
+
+    hash_destruir(hash);
+}
+
 static void prueba_hash_volumen(size_t largo, bool debug)
 {
     hash_t* hash = hash_crear(NULL);
@@ -264,6 +413,1108 @@ static void prueba_hash_volumen(size_t largo, bool debug)
 
 }
 
+static void prueba_hash_borrar_y_reinsertar(size_t largo, const hash_opciones_t* opciones)
+{
+    hash_t* hash = hash_crear_con_opciones(NULL, opciones);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+
+    /* Inserta 'largo' claves y borra las pares, dejando campos borrados */
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo; i += 2) {
+        ok &= hash_borrar(hash, claves[i]) == claves[i];
+    }
+    print_test("Prueba hash guardar y borrar la mitad", ok);
+    print_test("Prueba hash la cantidad de elementos es la mitad", hash_cantidad(hash) == largo / 2);
+
+    /* Las impares se siguen encontrando detras de los borrados */
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        bool esperado = i % 2 == 1;
+        ok &= hash_pertenece(hash, claves[i]) == esperado;
+        ok &= hash_obtener(hash, claves[i]) == (esperado ? claves[i] : NULL);
+    }
+    print_test("Prueba hash buscar con campos borrados", ok);
+
+    /* Reinserta las pares, reutilizando los campos borrados */
+    ok = true;
+    for (size_t i = 0; i < largo; i += 2) {
+        ok &= hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo; i++) {
+        ok &= hash_obtener(hash, claves[i]) == claves[i];
+    }
+    print_test("Prueba hash reinsertar claves borradas", ok);
+    print_test("Prueba hash la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
+    print_test("Prueba hash pertenece clave inexistente, es false", !hash_pertenece(hash, "no existe"));
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+static uint64_t hash_constante(const void *clave, size_t largo, uint64_t semilla)
+{
+    (void) clave;
+    (void) largo;
+    (void) semilla;
+    return 7;
+}
+
+static bool guardar_y_verificar(hash_t* hash, size_t largo)
+{
+    char clave[24];
+    bool ok = hash != NULL;
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        ok = hash_guardar(hash, clave, hash);
+    }
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        ok = hash_obtener(hash, clave) == hash;
+    }
+    return ok && hash_cantidad(hash) == largo && !hash_pertenece(hash, "no existe");
+}
+
+static void prueba_hash_funciones(size_t largo)
+{
+    hash_opciones_t opciones = {0};
+
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash funcion rapida guardar y obtener", guardar_y_verificar(hash, largo));
+    hash_destruir(hash);
+
+    opciones.funcion = HASH_FUNCION_CLASICA;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash funcion clasica guardar y obtener", guardar_y_verificar(hash, largo));
+    hash_destruir(hash);
+
+    /* Con una semilla fija la distribucion se repite entre tablas */
+    hash_informe_sondeo_t informe1, informe2;
+    opciones.funcion = HASH_FUNCION_RAPIDA;
+    opciones.semilla = 1234;
+    hash_t* hash1 = hash_crear_con_opciones(NULL, &opciones);
+    hash_t* hash2 = hash_crear_con_opciones(NULL, &opciones);
+    guardar_y_verificar(hash1, largo);
+    guardar_y_verificar(hash2, largo);
+    hash_informe_sondeo(hash1, &informe1);
+    hash_informe_sondeo(hash2, &informe2);
+    print_test("Prueba hash semilla fija reproduce las colisiones",
+               informe1.colisiones == informe2.colisiones && informe1.largo_max == informe2.largo_max);
+    print_test("Prueba hash informe de sondeo, largo maximo al menos 1", informe1.largo_max >= 1);
+    hash_destruir(hash1);
+    hash_destruir(hash2);
+
+    /* Una funcion propia en la que todo colisiona sigue siendo correcta */
+    opciones.funcion_propia = hash_constante;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash funcion propia guardar y obtener", guardar_y_verificar(hash, 100));
+    hash_informe_sondeo(hash, &informe1);
+    print_test("Prueba hash funcion propia, todas menos una colisionan", informe1.colisiones == 99);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_robin_hood(size_t largo)
+{
+    hash_opciones_t opciones = {0};
+    opciones.sondeo = HASH_SONDEO_ROBIN_HOOD;
+
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash Robin Hood guardar y obtener", guardar_y_verificar(hash, largo));
+    hash_destruir(hash);
+
+    prueba_hash_borrar_y_reinsertar(largo, &opciones);
+
+    /* Con todas las claves colisionando, borrar corre las siguientes */
+    opciones.funcion_propia = hash_constante;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash Robin Hood todas colisionan", guardar_y_verificar(hash, 50));
+    print_test("Prueba hash Robin Hood borrar la primera", hash_borrar(hash, "00000000") == hash);
+    print_test("Prueba hash Robin Hood borrar una del medio", hash_borrar(hash, "00000025") == hash);
+    print_test("Prueba hash Robin Hood sigue la ultima", hash_obtener(hash, "00000049") == hash);
+    print_test("Prueba hash Robin Hood no esta la borrada", !hash_pertenece(hash, "00000025"));
+    hash_informe_sondeo_t informe;
+    hash_informe_sondeo(hash, &informe);
+    print_test("Prueba hash Robin Hood el sondeo no deja huecos", informe.largo_max == 48);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_grupos(size_t largo)
+{
+    hash_opciones_t opciones = {0};
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash grupos guardar y obtener", guardar_y_verificar(hash, largo));
+    hash_destruir(hash);
+
+    prueba_hash_borrar_y_reinsertar(largo, &opciones);
+
+    /* Con la misma etiqueta en todas, cada ventana compara varias claves */
+    opciones.funcion_propia = hash_constante;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash grupos todas colisionan", guardar_y_verificar(hash, 100));
+    print_test("Prueba hash grupos borrar una del medio", hash_borrar(hash, "00000050") == hash);
+    print_test("Prueba hash grupos sigue la ultima", hash_obtener(hash, "00000099") == hash);
+    print_test("Prueba hash grupos no esta la borrada", !hash_pertenece(hash, "00000050"));
+    hash_destruir(hash);
+}
+
+static void prueba_hash_incremental(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_ROBIN_HOOD, HASH_SONDEO_GRUPOS};
+    hash_opciones_t opciones = {0};
+    opciones.incremental = true;
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        opciones.sondeo = sondeos[i];
+        hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+        print_test("Prueba hash incremental guardar y obtener", guardar_y_verificar(hash, largo));
+        hash_destruir(hash);
+        prueba_hash_borrar_y_reinsertar(largo, &opciones);
+    }
+
+    /* Justo despues de crecer conviven las dos tablas */
+    char clave[24];
+    hash_memoria_t memoria;
+    opciones.sondeo = HASH_SONDEO_LINEAL;
+    hash_t* hash = hash_crear_con_opciones(free, &opciones);
+    size_t n = 0;
+    hash_memoria(hash, &memoria);
+    size_t bytes_inicial = memoria.bytes_campos;
+    while (memoria.bytes_campos == bytes_inicial) {
+        sprintf(clave, "%08zu", n++);
+        hash_guardar(hash, clave, malloc(1));
+        hash_memoria(hash, &memoria);
+    }
+    print_test("Prueba hash incremental conserva la tabla vieja", memoria.bytes_campos == 3 * bytes_inicial);
+
+    bool ok = true;
+    for (size_t j = 0; j < n; j++) {
+        sprintf(clave, "%08zu", j);
+        ok &= hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash incremental busca en las dos tablas", ok);
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) recorridos++;
+    hash_iter_destruir(iter);
+    print_test("Prueba hash incremental iterar recorre las dos tablas", recorridos == n);
+    print_test("Prueba hash incremental reemplazar una clave vieja", hash_guardar(hash, "00000000", malloc(1)));
+    free(hash_borrar(hash, "00000001"));
+    print_test("Prueba hash incremental borrar una clave vieja", !hash_pertenece(hash, "00000001"));
+    print_test("Prueba hash incremental cantidad", hash_cantidad(hash) == n - 1);
+
+    /* Cada operacion migra un tramo acotado hasta terminar */
+    for (size_t j = 0; j < bytes_inicial && memoria.bytes_campos != 2 * bytes_inicial; j++) {
+        hash_borrar(hash, "no existe");
+        hash_memoria(hash, &memoria);
+    }
+    print_test("Prueba hash incremental termina de migrar", memoria.bytes_campos == 2 * bytes_inicial);
+    print_test("Prueba hash incremental sigue la primera", hash_pertenece(hash, "00000000"));
+    hash_destruir(hash);
+}
+
+/* Guarda largo claves y devuelve si en ningun momento cambio el tamaño de
+ * la tabla. */
+static bool guardar_sin_redimensionar(hash_t* hash, size_t largo)
+{
+    char clave[24];
+    hash_memoria_t antes, despues;
+    hash_memoria(hash, &antes);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        ok &= hash_guardar(hash, clave, hash);
+        hash_memoria(hash, &despues);
+        ok &= despues.bytes_campos == antes.bytes_campos;
+    }
+    return ok && hash_cantidad(hash) == largo;
+}
+
+static void prueba_hash_capacidad(size_t largo)
+{
+    hash_t* hash = hash_crear_con_capacidad(largo, NULL);
+    print_test("Prueba hash crear con capacidad", hash != NULL);
+    print_test("Prueba hash con capacidad no redimensiona", guardar_sin_redimensionar(hash, largo));
+
+    /* Al borrar no se achica por debajo de lo reservado */
+    char clave[24];
+    hash_memoria_t antes, despues;
+    hash_memoria(hash, &antes);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        hash_borrar(hash, clave);
+    }
+    hash_memoria(hash, &despues);
+    print_test("Prueba hash con capacidad no se achica", despues.bytes_campos == antes.bytes_campos);
+    hash_destruir(hash);
+
+    hash = hash_crear(NULL);
+    print_test("Prueba hash guardar antes de reservar", hash_guardar(hash, "perro", "guau"));
+    print_test("Prueba hash reservar", hash_reservar(hash, largo));
+    print_test("Prueba hash reservar conserva los datos", hash_obtener(hash, "perro") != NULL);
+    print_test("Prueba hash reservar menos no hace nada", hash_reservar(hash, 1));
+    hash_borrar(hash, "perro");
+    print_test("Prueba hash despues de reservar no redimensiona", guardar_sin_redimensionar(hash, largo));
+    hash_destruir(hash);
+
+    /* Construccion en lote */
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** valores = malloc(largo * sizeof(void*));
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08zu", i);
+        punteros[i] = claves[i];
+        valores[i] = malloc(sizeof(size_t));
+        *(size_t*) valores[i] = i;
+    }
+    hash = hash_construir_lote(punteros, valores, largo, free);
+    bool ok = hash != NULL && hash_cantidad(hash) == largo;
+    for (size_t i = 0; ok && i < largo; i++) {
+        size_t* valor = hash_obtener(hash, claves[i]);
+        ok = valor != NULL && *valor == i;
+    }
+    print_test("Prueba hash construir lote", ok);
+    print_test("Prueba hash construir lote, clave inexistente", !hash_pertenece(hash, "no existe"));
+    print_test("Prueba hash construir lote admite guardar", hash_guardar(hash, "nueva", NULL));
+    hash_destruir(hash);
+
+    hash = hash_construir_lote(punteros, NULL, largo, NULL);
+    print_test("Prueba hash construir lote sin valores",
+               hash != NULL && hash_pertenece(hash, claves[largo - 1]) && hash_obtener(hash, claves[0]) == NULL);
+    hash_destruir(hash);
+
+    hash = hash_construir_lote(NULL, NULL, 0, NULL);
+    print_test("Prueba hash construir lote vacio", hash != NULL && hash_cantidad(hash) == 0);
+    hash_destruir(hash);
+
+    free(valores);
+    free(punteros);
+    free(claves);
+}
+
+/* Compara las busquedas en lote con las individuales, sobre claves
+ * presentes y ausentes mezcladas. */
+static bool lote_igual_a_individual(const hash_t* hash, const char** claves, size_t n)
+{
+    void** valores = malloc(n * sizeof(void*));
+    bool* pertenece = malloc(n * sizeof(bool));
+    hash_obtener_lote(hash, claves, n, valores);
+    hash_pertenece_lote(hash, claves, n, pertenece);
+    bool ok = true;
+    for (size_t i = 0; i < n; i++) {
+        ok &= valores[i] == hash_obtener(hash, claves[i]);
+        ok &= pertenece[i] == hash_pertenece(hash, claves[i]);
+    }
+    free(valores);
+    free(pertenece);
+    return ok;
+}
+
+static void prueba_hash_lote(size_t largo)
+{
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(2 * largo * largo_clave);
+    const char** punteros = malloc(2 * largo * sizeof(char*));
+    for (size_t i = 0; i < 2 * largo; i++) {
+        // Las impares son largas, para que se guarden fuera del campo
+        sprintf(claves[i], i % 2 ? "clave larga numero %08zu" : "%08zu", i);
+        punteros[i] = claves[i];
+    }
+
+    hash_t* hash = hash_crear(NULL);
+    void* valor = NULL;
+    bool pertenece = true;
+    hash_obtener_lote(hash, punteros, 1, &valor);
+    hash_pertenece_lote(hash, punteros, 1, &pertenece);
+    print_test("Prueba hash lote en hash vacio", valor == NULL && !pertenece);
+    hash_obtener_lote(hash, punteros, 0, NULL);
+
+    /* Se guarda solo la primera mitad; la otra queda para los fallos */
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], claves[i]);
+    print_test("Prueba hash obtener y pertenece en lote", lote_igual_a_individual(hash, punteros, 2 * largo));
+    print_test("Prueba hash lote de largo no multiplo del bloque", lote_igual_a_individual(hash, punteros + 3, 21));
+    hash_destruir(hash);
+
+    hash_opciones_t opciones = {0};
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+    opciones.incremental = true;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], claves[i]);
+    print_test("Prueba hash lote con grupos e incremental", lote_igual_a_individual(hash, punteros, 2 * largo));
+    hash_destruir(hash);
+
+    free(punteros);
+    free(claves);
+}
+
+#define HILOS 4
+
+typedef struct trabajo {
+    hash_sharded_t* hash;
+    size_t hilo;
+    size_t largo;
+    bool ok;
+} trabajo_t;
+
+/* Cada hilo guarda sus propias claves, lee y borra las pares, y
+ * reemplaza muchas veces una clave que comparten todos. */
+static void* trabajar(void* extra)
+{
+    trabajo_t* trabajo = extra;
+    char clave[24];
+    trabajo->ok = true;
+    for (size_t i = 0; i < trabajo->largo; i++) {
+        sprintf(clave, "%zu-%08zu", trabajo->hilo, i);
+        trabajo->ok &= hash_sharded_guardar(trabajo->hash, clave, malloc(1));
+        trabajo->ok &= hash_sharded_guardar(trabajo->hash, "compartida", malloc(1));
+    }
+    for (size_t i = 0; i < trabajo->largo; i += 2) {
+        sprintf(clave, "%zu-%08zu", trabajo->hilo, i);
+        trabajo->ok &= hash_sharded_obtener(trabajo->hash, clave) != NULL;
+        free(hash_sharded_borrar(trabajo->hash, clave));
+    }
+    return NULL;
+}
+
+static void prueba_hash_sharded(size_t largo)
+{
+    hash_sharded_t* hash = hash_sharded_crear(0, free, NULL);
+    print_test("Prueba hash sharded crear", hash != NULL);
+    hash_sharded_iter_t* iter = hash_sharded_iter_crear(hash);
+    print_test("Prueba hash sharded iterar vacio", hash_sharded_iter_al_final(iter));
+    print_test("Prueba hash sharded iterar vacio ver actual", hash_sharded_iter_ver_actual(iter) == NULL);
+    hash_sharded_iter_destruir(iter);
+    print_test("Prueba hash sharded vacio", hash_sharded_cantidad(hash) == 0);
+    print_test("Prueba hash sharded guardar", hash_sharded_guardar(hash, "perro", malloc(1)));
+    print_test("Prueba hash sharded reemplazar", hash_sharded_guardar(hash, "perro", malloc(1))
+               && hash_sharded_cantidad(hash) == 1);
+    print_test("Prueba hash sharded pertenece", hash_sharded_pertenece(hash, "perro"));
+    print_test("Prueba hash sharded no pertenece", !hash_sharded_pertenece(hash, "gato"));
+    print_test("Prueba hash sharded obtener inexistente", hash_sharded_obtener(hash, "gato") == NULL);
+    print_test("Prueba hash sharded borrar inexistente", hash_sharded_borrar(hash, "gato") == NULL);
+
+    pthread_t hilos[HILOS];
+    trabajo_t trabajos[HILOS];
+    for (size_t i = 0; i < HILOS; i++) {
+        trabajos[i] = (trabajo_t) {hash, i, largo, false};
+        pthread_create(&hilos[i], NULL, trabajar, &trabajos[i]);
+    }
+    bool ok = true;
+    for (size_t i = 0; i < HILOS; i++) {
+        pthread_join(hilos[i], NULL);
+        ok &= trabajos[i].ok;
+    }
+    print_test("Prueba hash sharded varios hilos", ok);
+    size_t esperados = HILOS * (largo / 2) + 2;
+    print_test("Prueba hash sharded cantidad de todos los shards", hash_sharded_cantidad(hash) == esperados);
+    char clave[24];
+    ok = true;
+    for (size_t h = 0; h < HILOS; h++) {
+        for (size_t i = 0; i < largo; i++) {
+            sprintf(clave, "%zu-%08zu", h, i);
+            ok &= hash_sharded_pertenece(hash, clave) == (i % 2 == 1);
+        }
+    }
+    print_test("Prueba hash sharded quedan las claves impares", ok);
+
+    /* El iterador pasa por todas las claves de todos los shards */
+    size_t recorridos = 0;
+    ok = true;
+    iter = hash_sharded_iter_crear(hash);
+    for (; !hash_sharded_iter_al_final(iter); hash_sharded_iter_avanzar(iter)) {
+        ok &= hash_sharded_pertenece(hash, hash_sharded_iter_ver_actual(iter));
+        recorridos++;
+    }
+    print_test("Prueba hash sharded iterar", ok && recorridos == esperados);
+    print_test("Prueba hash sharded iterador al final no avanza", !hash_sharded_iter_avanzar(iter));
+    hash_sharded_iter_destruir(iter);
+    hash_sharded_destruir(hash);
+
+    /* Un solo shard se comporta como un hash comun */
+    hash = hash_sharded_crear(1, NULL, NULL);
+    print_test("Prueba hash sharded un shard", hash_sharded_guardar(hash, "perro", "guau") && hash_sharded_cantidad(hash) == 1);
+    print_test("Prueba hash sharded un shard borrar", hash_sharded_borrar(hash, "perro") != NULL);
+    hash_sharded_destruir(hash);
+}
+
+/* Dos tablas con la misma semilla: el hash calculado con una sirve para
+ * la otra. */
+static void prueba_hash_con_hash(size_t largo)
+{
+    hash_opciones_t opciones = {0};
+    opciones.semilla = 1234;
+    hash_t* a = hash_crear_con_opciones(NULL, &opciones);
+    hash_t* b = hash_crear_con_opciones(NULL, &opciones);
+    char clave[24];
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        size_t n = strlen(clave);
+        uint64_t h = hash_hash_clave(a, clave, n);
+        ok &= h == hash_hash_clave(b, clave, n) && hash_guardar_con_hash(b, clave, n, h, (void*) (i + 1));
+    }
+    print_test("Prueba hash con hash guardar", ok && hash_cantidad(b) == largo);
+    ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        uint64_t h = hash_hash_clave(a, clave, 8);
+        ok &= hash_obtener(b, clave) == (void*) (i + 1) && hash_obtener_con_hash(b, clave, 8, h) == (void*) (i + 1)
+              && hash_pertenece_con_hash(b, clave, 8, h);
+    }
+    print_test("Prueba hash con hash obtener y pertenece", ok);
+    ok = true;
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "%08zu", i);
+        ok &= hash_borrar_con_hash(b, clave, 8, hash_hash_clave(a, clave, 8)) == (void*) (i + 1);
+    }
+    print_test("Prueba hash con hash borrar", ok && hash_cantidad(b) == largo / 2 && !hash_pertenece(b, "00000000"));
+    hash_destruir(a);
+    hash_destruir(b);
+}
+
+/* Con hilos, las tablas de mas de 2^16 posiciones se redimensionan,
+ * construyen y destruyen en paralelo. */
+static void prueba_hash_paralelo(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_GRUPOS, HASH_SONDEO_ROBIN_HOOD};
+    hash_opciones_t opciones = {0};
+    opciones.hilos = HILOS;
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        opciones.sondeo = sondeos[i];
+        hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+        print_test("Prueba hash paralelo guardar y obtener", guardar_y_verificar(hash, largo));
+
+        /* Al borrar casi todo se achica, tambien en paralelo */
+        char clave[24];
+        bool ok = true;
+        for (size_t j = 0; j < largo; j++) {
+            if (j % 8 == 0) continue;
+            sprintf(clave, "%08zu", j);
+            ok &= hash_borrar(hash, clave) == hash;
+        }
+        for (size_t j = 0; j < largo; j += 8) {
+            sprintf(clave, "%08zu", j);
+            ok &= hash_obtener(hash, clave) == hash;
+        }
+        print_test("Prueba hash paralelo achicar", ok && hash_cantidad(hash) == (largo + 7) / 8);
+        hash_destruir(hash);
+    }
+
+    /* Construccion en lote, con claves cortas y largas */
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** valores = malloc(largo * sizeof(void*));
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(claves[i], i % 3 ? "%08zu" : "una clave larga, la %08zu", i);
+        punteros[i] = claves[i];
+        valores[i] = malloc(sizeof(size_t));
+        *(size_t*) valores[i] = i;
+    }
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+    opciones.destruir_en_paralelo = true;
+    hash_t* hash = hash_construir_lote_con_opciones(punteros, valores, largo, free, &opciones);
+    bool ok = hash != NULL && hash_cantidad(hash) == largo;
+    for (size_t i = 0; ok && i < largo; i++) {
+        size_t* valor = hash_obtener(hash, claves[i]);
+        ok = valor != NULL && *valor == i;
+    }
+    print_test("Prueba hash paralelo construir lote", ok);
+    print_test("Prueba hash paralelo construir lote, clave inexistente", !hash_pertenece(hash, "no existe"));
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) recorridos++;
+    hash_iter_destruir(iter);
+    print_test("Prueba hash paralelo construir lote, iterar", recorridos == largo);
+    print_test("Prueba hash paralelo guardar despues del lote", hash_guardar(hash, "nueva", malloc(1)));
+    // destruir libera los valores desde varios hilos
+    hash_destruir(hash);
+
+    free(valores);
+    free(punteros);
+    free(claves);
+}
+
+/* Cada hilo recorre su rango y marca las claves que ve. */
+typedef struct rango {
+    pthread_t id;
+    const hash_t* hash;
+    size_t inicio, fin;
+    size_t* vistas;
+} rango_t;
+
+static void* recorrer_rango(void* extra)
+{
+    rango_t* rango = extra;
+    hash_iter_t* iter = hash_iter_crear_rango(rango->hash, rango->inicio, rango->fin);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        // Cada clave cae en un solo rango, no hay dos hilos en la misma posición
+        rango->vistas[strtoul(hash_iter_ver_actual(iter), NULL, 10)]++;
+    }
+    hash_iter_destruir(iter);
+    return NULL;
+}
+
+// Recorre el hash con k iteradores de rango y verifica que cada clave
+// "%08zu" con i < largo aparezca exactamente una vez.
+static bool recorrer_en_rangos(const hash_t* hash, size_t largo, size_t k)
+{
+    size_t* limites = malloc((k + 1) * sizeof(size_t));
+    size_t* vistas = calloc(largo, sizeof(size_t));
+    rango_t* rangos = malloc(k * sizeof(rango_t));
+    size_t n = hash_dividir_rangos(hash, k, limites);
+    bool ok = n > 0 && n <= k && limites[0] == 0 && limites[n] == hash_posiciones(hash);
+    for (size_t i = 0; i < n; i++) {
+        ok &= limites[i] <= limites[i + 1];
+        rangos[i].hash = hash;
+        rangos[i].inicio = limites[i];
+        rangos[i].fin = limites[i + 1];
+        rangos[i].vistas = vistas;
+        pthread_create(&rangos[i].id, NULL, recorrer_rango, &rangos[i]);
+    }
+    for (size_t i = 0; i < n; i++) pthread_join(rangos[i].id, NULL);
+    for (size_t i = 0; i < largo; i++) ok &= vistas[i] == 1;
+    free(rangos);
+    free(vistas);
+    free(limites);
+    return ok;
+}
+
+static void prueba_hash_rangos(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_GRUPOS, HASH_SONDEO_ROBIN_HOOD};
+    hash_opciones_t opciones = {0};
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        opciones.sondeo = sondeos[i];
+        hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+        print_test("Prueba hash rangos guardar", guardar_y_verificar(hash, largo));
+        print_test("Prueba hash rangos, un solo rango", recorrer_en_rangos(hash, largo, 1));
+        print_test("Prueba hash rangos, varios hilos", recorrer_en_rangos(hash, largo, HILOS));
+        print_test("Prueba hash rangos, rangos de pocas posiciones", recorrer_en_rangos(hash, largo, 333));
+        hash_destruir(hash);
+    }
+
+    /* Tabla casi vacia: el iterador salta las posiciones vacias */
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+    opciones.capacidad = 1000000;
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    hash_guardar(hash, "00000000", hash);
+    hash_guardar(hash, "00000001", hash);
+    print_test("Prueba hash rangos, tabla casi vacia", recorrer_en_rangos(hash, 2, HILOS));
+    size_t posiciones = hash_posiciones(hash);
+    hash_iter_t* iter = hash_iter_crear_rango(hash, posiciones, posiciones + 10);
+    print_test("Prueba hash rango vacio esta al final", hash_iter_al_final(iter));
+    print_test("Prueba hash rango vacio no avanza", !hash_iter_avanzar(iter));
+    print_test("Prueba hash rango vacio ver actual es NULL", !hash_iter_ver_actual(iter));
+    hash_iter_destruir(iter);
+    hash_destruir(hash);
+
+    /* En medio de una redimension incremental tambien se recorre la tabla vieja */
+    opciones.capacidad = 0;
+    opciones.incremental = true;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash rangos incremental guardar", guardar_y_verificar(hash, largo));
+    print_test("Prueba hash rangos incremental, varios hilos", recorrer_en_rangos(hash, largo, HILOS));
+    hash_destruir(hash);
+}
+
+static void prueba_hash_congelar(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_GRUPOS, HASH_SONDEO_ROBIN_HOOD};
+    hash_opciones_t opciones = {0};
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** resultados = malloc(largo * sizeof(void*));
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        opciones.sondeo = sondeos[i];
+        // En lineal se congela en medio de una redimension incremental
+        opciones.incremental = sondeos[i] == HASH_SONDEO_LINEAL;
+        hash_t* hash = hash_crear_con_opciones(free, &opciones);
+        for (size_t j = 0; j < largo; j++) {
+            sprintf(claves[j], j % 3 ? "%08zu" : "una clave de mas de quince, %08zu", j);
+            punteros[j] = claves[j];
+            size_t* valor = malloc(sizeof(size_t));
+            *valor = j;
+            hash_guardar(hash, claves[j], valor);
+        }
+        // Borrados antes de congelar: dejan BORRADO y basura en la arena
+        for (size_t j = 0; j < largo; j += 10) free(hash_borrar(hash, claves[j]));
+        hash_memoria_t antes, despues;
+        hash_memoria(hash, &antes);
+
+        print_test("Prueba hash congelar", hash_congelar(hash) && hash_congelado(hash));
+        print_test("Prueba hash congelar cantidad", hash_cantidad(hash) == largo - (largo + 9) / 10);
+        bool ok = true;
+        for (size_t j = 0; j < largo; j++) {
+            size_t* valor = hash_obtener(hash, claves[j]);
+            ok &= j % 10 == 0 ? valor == NULL && !hash_pertenece(hash, claves[j])
+                              : valor != NULL && *valor == j && hash_pertenece(hash, claves[j]);
+        }
+        print_test("Prueba hash congelado obtener y pertenece", ok);
+        print_test("Prueba hash congelado clave inexistente", !hash_pertenece(hash, "no existe"));
+        hash_obtener_lote(hash, punteros, largo, resultados);
+        ok = true;
+        for (size_t j = 0; j < largo; j++) ok &= resultados[j] == hash_obtener(hash, claves[j]);
+        print_test("Prueba hash congelado obtener lote", ok);
+
+        hash_memoria(hash, &despues);
+        print_test("Prueba hash congelado ocupa menos", despues.bytes_campos < antes.bytes_campos && despues.bytes_basura == 0);
+        hash_informe_sondeo_t informe;
+        hash_informe_sondeo(hash, &informe);
+        print_test("Prueba hash congelado sondeo de una posicion", informe.colisiones == 0 && informe.largo_max == 1);
+        size_t recorridos = 0;
+        hash_iter_t* iter = hash_iter_crear(hash);
+        for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) recorridos++;
+        hash_iter_destruir(iter);
+        print_test("Prueba hash congelado iterar", recorridos == hash_cantidad(hash));
+
+        print_test("Prueba hash congelado guardar es false", !hash_guardar(hash, "nueva", NULL));
+        print_test("Prueba hash congelado reemplazar es false", !hash_guardar(hash, claves[1], NULL));
+        print_test("Prueba hash congelado borrar es NULL", !hash_borrar(hash, claves[1]) && hash_pertenece(hash, claves[1]));
+        print_test("Prueba hash congelado reservar es false", !hash_reservar(hash, largo * 2));
+        print_test("Prueba hash congelar de nuevo", hash_congelar(hash));
+        hash_destruir(hash);
+    }
+
+    hash_t* hash = hash_crear(NULL);
+    print_test("Prueba hash congelar vacio", hash_congelar(hash) && hash_cantidad(hash) == 0);
+    print_test("Prueba hash congelado vacio no pertenece", !hash_pertenece(hash, "") && !hash_obtener(hash, "a"));
+    hash_obtener_lote(hash, punteros, 1, resultados);
+    print_test("Prueba hash congelado vacio obtener lote", resultados[0] == NULL);
+    hash_destruir(hash);
+
+    /* Con el mismo hash para todas las claves no hay funcion perfecta */
+    opciones.sondeo = HASH_SONDEO_LINEAL;
+    opciones.incremental = false;
+    opciones.funcion_propia = hash_constante;
+    hash = hash_crear_con_opciones(NULL, &opciones);
+    guardar_y_verificar(hash, 10);
+    print_test("Prueba hash congelar con hashes repetidos es false", !hash_congelar(hash) && !hash_congelado(hash));
+    print_test("Prueba hash sin congelar sigue funcionando", guardar_y_verificar(hash, 20));
+    hash_destruir(hash);
+
+    free(resultados);
+    free(punteros);
+    free(claves);
+}
+
+static void prueba_hash_estadisticas(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_GRUPOS, HASH_SONDEO_ROBIN_HOOD};
+    hash_opciones_t opciones = {0};
+    hash_estadisticas_t estadisticas;
+    char clave[24];
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        opciones.sondeo = sondeos[i];
+        hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+        hash_estadisticas(hash, &estadisticas);
+        print_test("Prueba hash estadisticas hash vacio", estadisticas.cantidad == 0 && estadisticas.carga == 0
+                   && estadisticas.sondeo_max == 0 && estadisticas.redimensiones == 0);
+
+        guardar_y_verificar(hash, largo);
+        for (size_t j = 0; j < largo; j += 4) {
+            sprintf(clave, "%08zu", j);
+            hash_borrar(hash, clave);
+        }
+        hash_estadisticas(hash, &estadisticas);
+        size_t en_histograma = 0;
+        for (size_t j = 0; j < HASH_HISTOGRAMA; j++) en_histograma += estadisticas.histograma[j];
+        print_test("Prueba hash estadisticas cantidad y carga", estadisticas.cantidad == hash_cantidad(hash)
+                   && estadisticas.carga == (double) estadisticas.cantidad / (double) estadisticas.capacidad);
+        print_test("Prueba hash estadisticas histograma", en_histograma == estadisticas.cantidad);
+        print_test("Prueba hash estadisticas sondeo", estadisticas.sondeo_promedio >= 1
+                   && estadisticas.sondeo_max >= estadisticas.sondeo_promedio);
+        print_test("Prueba hash estadisticas redimensiones", estadisticas.redimensiones > 0);
+        print_test("Prueba hash estadisticas borrados", sondeos[i] == HASH_SONDEO_ROBIN_HOOD
+                   ? estadisticas.borrados == 0 : estadisticas.borrados > 0);
+        print_test("Prueba hash estadisticas memoria", estadisticas.bytes_campos > 0);
+
+        hash_informe_sondeo_t informe;
+        hash_informe_sondeo(hash, &informe);
+        print_test("Prueba hash estadisticas coincide con el informe", informe.largo_max == estadisticas.sondeo_max
+                   && informe.colisiones == estadisticas.cantidad - estadisticas.histograma[0]);
+        hash_destruir(hash);
+    }
+
+    /* Con la misma funcion para todas las claves el sondeo crece */
+    opciones.sondeo = HASH_SONDEO_LINEAL;
+    opciones.funcion_propia = hash_constante;
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    guardar_y_verificar(hash, 100);
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas con colisiones", estadisticas.sondeo_max == 100
+               && estadisticas.histograma[0] == 1 && estadisticas.histograma[6] == 37);
+    hash_destruir(hash);
+
+    /* Los contadores de busquedas solo existen con HASH_ESTADISTICAS */
+    hash = hash_crear(NULL);
+    hash_guardar(hash, "a", hash);
+    hash_estadisticas(hash, &estadisticas);
+    uint64_t aciertos = estadisticas.aciertos, fallos = estadisticas.fallos;
+    hash_obtener(hash, "a");
+    hash_pertenece(hash, "b");
+    hash_buscar_ptr(hash, "c");
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash estadisticas contadores", estadisticas.contadores
+               ? estadisticas.aciertos == aciertos + 1 && estadisticas.fallos == fallos + 2
+               : estadisticas.aciertos == 0 && estadisticas.fallos == 0);
+    hash_destruir(hash);
+}
+
+/* Con altas y bajas sostenidas la cantidad no cambia pero se acumulan
+ * BORRADO: la tabla tiene que limpiarlos sin cambiar de capacidad. */
+static void prueba_hash_recompactar(size_t largo)
+{
+    hash_sondeo_t sondeos[] = {HASH_SONDEO_LINEAL, HASH_SONDEO_GRUPOS, HASH_SONDEO_LINEAL};
+    bool incremental[] = {false, false, true};
+    hash_estadisticas_t antes, despues;
+    char clave[24];
+
+    for (size_t i = 0; i < sizeof(sondeos) / sizeof(sondeos[0]); i++) {
+        hash_opciones_t opciones = {0};
+        opciones.sondeo = sondeos[i];
+        opciones.incremental = incremental[i];
+        hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+        for (size_t j = 0; j < largo; j++) {
+            sprintf(clave, "%08zu", j);
+            hash_guardar(hash, clave, (void*) (j + 1));
+        }
+        hash_estadisticas(hash, &antes);
+
+        /* Se borra la clave mas vieja y se agrega una nueva */
+        for (size_t j = largo; j < 20 * largo; j++) {
+            sprintf(clave, "%08zu", j - largo);
+            hash_borrar(hash, clave);
+            sprintf(clave, "%08zu", j);
+            hash_guardar(hash, clave, (void*) (j + 1));
+        }
+        hash_estadisticas(hash, &despues);
+        print_test("Prueba hash recompactar mantiene la cantidad", hash_cantidad(hash) == largo);
+        print_test("Prueba hash recompactar no cambia la capacidad", despues.capacidad == antes.capacidad
+                   && despues.redimensiones == antes.redimensiones);
+        print_test("Prueba hash recompactar limpia los borrados", despues.recompactaciones > 0
+                   && (double) (despues.cantidad + despues.borrados) < 0.7 * (double) despues.capacidad);
+        print_test("Prueba hash recompactar sondeo corto", despues.sondeo_promedio < 3);
+
+        bool ok = true;
+        for (size_t j = 0; j < 20 * largo && ok; j++) {
+            sprintf(clave, "%08zu", j);
+            void* esperado = j < 19 * largo ? NULL : (void*) (j + 1);
+            ok = hash_obtener(hash, clave) == esperado && hash_pertenece(hash, clave) == (esperado != NULL);
+        }
+        print_test("Prueba hash recompactar conserva las claves", ok);
+        hash_destruir(hash);
+    }
+}
+
+static bool sumar_enteros(uint64_t clave, uint64_t* valor, void* extra)
+{
+    *(uint64_t*) extra += clave + *valor;
+    return true;
+}
+
+static void prueba_hash_generico(size_t largo)
+{
+    hash_enteros_t* hash = hash_enteros_crear();
+    print_test("Prueba hash generico crear", hash && hash_enteros_cantidad(hash) == 0);
+    print_test("Prueba hash generico obtener en vacio es NULL", !hash_enteros_obtener(hash, 0));
+
+    /* La clave 0 es una clave mas */
+    bool ok = true;
+    for (uint64_t i = 0; i < largo; i++) ok &= hash_enteros_guardar(hash, i * 3, i);
+    print_test("Prueba hash generico guardar muchas", ok && hash_enteros_cantidad(hash) == largo);
+    ok = true;
+    for (uint64_t i = 0; i < largo && ok; i++) {
+        uint64_t* valor = hash_enteros_obtener(hash, i * 3);
+        ok = valor && *valor == i && !hash_enteros_pertenece(hash, i * 3 + 1);
+    }
+    print_test("Prueba hash generico obtener muchas", ok);
+
+    hash_enteros_guardar(hash, 0, 42);
+    print_test("Prueba hash generico reemplazar", *hash_enteros_obtener(hash, 0) == 42
+               && hash_enteros_cantidad(hash) == largo);
+    *hash_enteros_obtener(hash, 0) = 0;
+
+    uint64_t esperado = 0, suma = 0;
+    for (uint64_t i = 0; i < largo; i++) esperado += i * 3 + i;
+    hash_enteros_para_cada(hash, sumar_enteros, &suma);
+    print_test("Prueba hash generico para cada", suma == esperado);
+
+    /* Borrar la mitad y rotar claves sin que cambie la cantidad */
+    uint64_t borrado = 0;
+    ok = true;
+    for (uint64_t i = 0; i < largo; i += 2) ok &= hash_enteros_borrar(hash, i * 3, &borrado) && borrado == i;
+    print_test("Prueba hash generico borrar", ok && hash_enteros_cantidad(hash) == largo / 2);
+    print_test("Prueba hash generico borrar inexistente", !hash_enteros_borrar(hash, 0, NULL));
+    for (uint64_t i = largo; i < 10 * largo; i++) {
+        hash_enteros_borrar(hash, (i - largo) * 3, NULL);
+        hash_enteros_guardar(hash, i * 3, i);
+    }
+    ok = hash_enteros_cantidad(hash) == largo;
+    for (uint64_t i = 0; i < 10 * largo && ok; i++) {
+        uint64_t* valor = hash_enteros_obtener(hash, i * 3);
+        ok = i < 9 * largo ? valor == NULL : valor && *valor == i;
+    }
+    print_test("Prueba hash generico rotar claves", ok);
+    hash_enteros_destruir(hash);
+
+    /* Claves struct */
+    hash_puntos_t* puntos = hash_puntos_crear();
+    punto_t origen = {0, 0}, punto = {-1, 7}, otro = {7, -1};
+    hash_puntos_guardar(puntos, origen, "origen");
+    hash_puntos_guardar(puntos, punto, "punto");
+    const char** valor = hash_puntos_obtener(puntos, punto);
+    print_test("Prueba hash generico clave struct", valor && strcmp(*valor, "punto") == 0
+               && hash_puntos_pertenece(puntos, origen) && !hash_puntos_pertenece(puntos, otro));
+    hash_puntos_destruir(puntos);
+}
+
+static bool contar_en_set(const char* clave, size_t largo, void* extra)
+{
+    hash_set_t** sets = extra;
+    return largo == strlen(clave) && hash_set_pertenece(sets[0], clave) && hash_set_guardar(sets[1], clave);
+}
+
+/* Verifica que set tenga exactamente las claves i del rango [desde, hasta)
+ * con i % paso == 0. */
+static bool set_es_rango(const hash_set_t* set, size_t desde, size_t hasta, size_t paso, const char* prefijo)
+{
+    char clave[48];
+    size_t cantidad = 0;
+    for (size_t i = 0; i < hasta + paso; i++) {
+        sprintf(clave, "%s%08zu", prefijo, i);
+        bool esperado = i >= desde && i < hasta && i % paso == 0;
+        if (hash_set_pertenece(set, clave) != esperado) return false;
+        cantidad += esperado;
+    }
+    return hash_set_cantidad(set) == cantidad;
+}
+
+static void prueba_hash_set(size_t largo)
+{
+    /* Claves cortas y largas (de mas de 15 bytes) */
+    const char* prefijos[] = {"c", "una clave bastante larga "};
+    char clave[48];
+
+    for (size_t p = 0; p < sizeof(prefijos) / sizeof(prefijos[0]); p++) {
+        hash_set_t* set = hash_set_crear();
+        print_test("Prueba hash set crear", set && hash_set_cantidad(set) == 0 && !hash_set_pertenece(set, "A"));
+
+        bool ok = true;
+        for (size_t i = 0; i < largo; i++) {
+            sprintf(clave, "%s%08zu", prefijos[p], i);
+            ok &= hash_set_guardar(set, clave);
+        }
+        sprintf(clave, "%s%08zu", prefijos[p], (size_t) 0);
+        ok &= hash_set_guardar(set, clave);
+        print_test("Prueba hash set guardar muchas", ok && set_es_rango(set, 0, largo, 1, prefijos[p]));
+        print_test("Prueba hash set clave con _n", hash_set_guardar_n(set, "a\0b", 3)
+                   && hash_set_pertenece_n(set, "a\0b", 3) && !hash_set_pertenece(set, "a")
+                   && hash_set_borrar_n(set, "a\0b", 3) && !hash_set_borrar_n(set, "a\0b", 3));
+
+        ok = true;
+        for (size_t i = 1; i < largo; i += 2) {
+            sprintf(clave, "%s%08zu", prefijos[p], i);
+            ok &= hash_set_borrar(set, clave);
+        }
+        print_test("Prueba hash set borrar", ok && set_es_rango(set, 0, largo, 2, prefijos[p]));
+
+        hash_set_t* copia = hash_set_crear();
+        hash_set_t* sets[] = {set, copia};
+        hash_set_para_cada(set, contar_en_set, sets);
+        print_test("Prueba hash set para cada", hash_set_cantidad(copia) == hash_set_cantidad(set));
+        hash_set_destruir(copia);
+        hash_set_destruir(set);
+    }
+
+    /* a: multiplos de 2 en [0, largo); b: multiplos de 3 en [largo/2, largo) */
+    hash_set_t* a = hash_set_crear();
+    hash_set_t* b = hash_set_crear();
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "c%08zu", i);
+        if (i % 2 == 0) hash_set_guardar(a, clave);
+        if (i % 3 == 0 && i >= largo / 2) hash_set_guardar(b, clave);
+    }
+    hash_set_t* u = hash_set_union(a, b);
+    hash_set_t* n = hash_set_interseccion(a, b);
+    hash_set_t* d = hash_set_diferencia(a, b);
+    bool ok = u && n && d;
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "c%08zu", i);
+        bool en_a = i % 2 == 0, en_b = i % 3 == 0 && i >= largo / 2;
+        ok = hash_set_pertenece(u, clave) == (en_a || en_b) && hash_set_pertenece(n, clave) == (en_a && en_b)
+             && hash_set_pertenece(d, clave) == (en_a && !en_b);
+    }
+    print_test("Prueba hash set union, interseccion y diferencia", ok);
+    print_test("Prueba hash set cantidades", ok && hash_set_cantidad(u) == hash_set_cantidad(a) + hash_set_cantidad(b)
+               - hash_set_cantidad(n) && hash_set_cantidad(d) == hash_set_cantidad(a) - hash_set_cantidad(n));
+
+    /* Operaciones encadenadas, y con un conjunto vacio */
+    hash_set_t* vacio = hash_set_crear();
+    hash_set_t* a_de_nuevo = hash_set_union(d, n);
+    hash_set_t* nada = hash_set_interseccion(a, vacio);
+    hash_set_t* todo = hash_set_diferencia(a, vacio);
+    hash_set_t* a_menos_a = hash_set_diferencia(a_de_nuevo, a);
+    print_test("Prueba hash set operaciones encadenadas", hash_set_cantidad(a_de_nuevo) == hash_set_cantidad(a)
+               && hash_set_cantidad(a_menos_a) == 0);
+    print_test("Prueba hash set operaciones con vacio", hash_set_cantidad(nada) == 0
+               && hash_set_cantidad(todo) == hash_set_cantidad(a) && set_es_rango(todo, 0, largo, 2, "c"));
+
+    /* Sin la columna de datos ocupa menos que un hash con las mismas claves */
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "c%08zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    hash_memoria_t memoria;
+    hash_memoria(hash, &memoria);
+    print_test("Prueba hash set ocupa menos que hash", hash_set_memoria(a) < memoria.bytes_total);
+    hash_destruir(hash);
+
+    hash_set_t* todos[] = {a, b, u, n, d, vacio, a_de_nuevo, nada, todo, a_menos_a};
+    for (size_t i = 0; i < sizeof(todos) / sizeof(todos[0]); i++) hash_set_destruir(todos[i]);
+}
+
+/* Allocator que cuenta pedidos y bytes vivos, para verificar cuántas
+ * reservas hace cada operación y que se devuelva todo con el tamaño
+ * correcto. */
+typedef struct contador {
+    size_t pedidos;
+    size_t liberaciones;
+    size_t bytes_vivos;
+} contador_t;
+
+static void *contador_pedir(void *contexto, size_t tam)
+{
+    contador_t *contador = contexto;
+    void *ptr = malloc(tam);
+    if (ptr) {
+        contador->pedidos++;
+        contador->bytes_vivos += tam;
+    }
+    return ptr;
+}
+
+static void contador_liberar(void *contexto, void *ptr, size_t tam)
+{
+    contador_t *contador = contexto;
+    contador->liberaciones++;
+    contador->bytes_vivos -= tam;
+    free(ptr);
+}
+
+static void prueba_hash_allocator(size_t largo)
+{
+    contador_t contador = {0, 0, 0};
+    hash_allocator_t allocator = {contador_pedir, contador_liberar, &contador};
+
+    hash_t* hash = hash_crear_con_allocator(NULL, &allocator);
+    print_test("Prueba hash crear con allocator", hash && contador.pedidos > 0);
+
+    size_t pedidos = contador.pedidos;
+    hash_guardar(hash, "perro", "guau");
+    hash_guardar(hash, "gato", "miau");
+    print_test("Prueba hash guardar claves cortas no pide memoria", contador.pedidos == pedidos);
+    hash_obtener(hash, "perro");
+    hash_pertenece(hash, "vaca");
+    hash_borrar(hash, "gato");
+    print_test("Prueba hash obtener, pertenece y borrar no piden memoria", contador.pedidos == pedidos);
+
+    hash_guardar(hash, "una clave que no entra en el campo", "largo");
+    hash_guardar(hash, "otra clave que tampoco entra en el campo", "largo");
+    print_test("Prueba hash dos claves largas piden un solo bloque", contador.pedidos == pedidos + 1);
+
+    pedidos = contador.pedidos;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    hash_iter_destruir(iter);
+    print_test("Prueba hash el iterador usa el allocator", contador.pedidos == pedidos + 1);
+
+    /* En volumen solo se pide memoria al redimensionar */
+    hash_borrar(hash, "perro");
+    hash_borrar(hash, "una clave que no entra en el campo");
+    hash_borrar(hash, "otra clave que tampoco entra en el campo");
+    pedidos = contador.pedidos;
+    print_test("Prueba hash guardar en volumen con allocator", guardar_y_verificar(hash, largo));
+    print_test("Prueba hash en volumen pide memoria pocas veces", contador.pedidos - pedidos < largo / 50);
+
+    hash_destruir(hash);
+    print_test("Prueba hash destruir devuelve todo lo pedido", contador.pedidos == contador.liberaciones);
+    print_test("Prueba hash destruir devuelve todos los bytes", contador.bytes_vivos == 0);
+
+    /* Las tablas generadas con HASH_DEFINIR tambien */
+    hash_opciones_t opciones_enteros = {0};
+    opciones_enteros.allocator = &allocator;
+    opciones_enteros.capacidad = largo;
+    hash_enteros_t* enteros = hash_enteros_crear_con_opciones(&opciones_enteros);
+    pedidos = contador.pedidos;
+    bool ok_enteros = enteros != NULL;
+    for (uint64_t i = 0; ok_enteros && i < largo; i++) ok_enteros = hash_enteros_guardar(enteros, i, i);
+    print_test("Prueba hash generico con allocator y capacidad no redimensiona", ok_enteros
+               && contador.pedidos == pedidos);
+    for (uint64_t i = 0; i < largo; i++) hash_enteros_borrar(enteros, i, NULL);
+    print_test("Prueba hash generico no se achica por debajo de la capacidad", contador.pedidos == pedidos);
+    hash_enteros_destruir(enteros);
+    print_test("Prueba hash generico destruir devuelve todo lo pedido", contador.pedidos == contador.liberaciones
+               && contador.bytes_vivos == 0);
+
+    /* El conjunto pide su memoria, y la de sus claves largas, al allocator */
+    hash_opciones_t opciones_set = {0};
+    opciones_set.allocator = &allocator;
+    opciones_set.capacidad = largo;
+    hash_set_t* set = hash_set_crear_con_opciones(&opciones_set);
+    opciones_set.allocator = NULL;
+    opciones_set.capacidad = 0;
+    opciones_set.funcion = HASH_FUNCION_CLASICA;
+    hash_set_t* clasico = hash_set_crear_con_opciones(&opciones_set);
+    pedidos = contador.pedidos;
+    bool ok = set && clasico;
+    char clave[48];
+    for (size_t i = 0; ok && i < largo; i++) {
+        sprintf(clave, "una clave bastante larga %08zu", i);
+        ok = hash_set_guardar(set, clave) && (i % 2 != 0 || hash_set_guardar(clasico, clave));
+    }
+    print_test("Prueba hash set con allocator y capacidad guardar", ok && hash_set_cantidad(set) == largo);
+    print_test("Prueba hash set claves largas en la arena", contador.pedidos - pedidos < largo / 50);
+    hash_set_t* comun = hash_set_interseccion(set, clasico);
+    print_test("Prueba hash set interseccion con otra funcion de hash", comun && hash_set_cantidad(comun) == (largo + 1) / 2);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "una clave bastante larga %08zu", i);
+        hash_set_borrar(set, clave);
+    }
+    hash_set_destruir(comun);
+    hash_set_destruir(clasico);
+    hash_set_destruir(set);
+    print_test("Prueba hash set destruir devuelve todo lo pedido", contador.pedidos == contador.liberaciones
+               && contador.bytes_vivos == 0);
+
+    /* Dos hashes comparten un pool, que se libera de una vez */
+    hash_pool_t* pool = hash_pool_crear(0);
+    hash_allocator_t de_pool = hash_pool_allocator(pool);
+    hash_opciones_t opciones = {0};
+    opciones.allocator = &de_pool;
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+    hash_t* hash1 = hash_crear_con_allocator(NULL, &de_pool);
+    hash_t* hash2 = hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash pool guardar y obtener", guardar_y_verificar(hash1, largo));
+    print_test("Prueba hash pool grupos guardar y obtener", guardar_y_verificar(hash2, largo));
+    print_test("Prueba hash pool reservo memoria", hash_pool_reservado(pool) > 0);
+    hash_destruir(hash1);
+    hash_destruir(hash2);
+    hash_pool_destruir(pool);
+}
+
 static ssize_t buscar(const char* clave, char* claves[], size_t largo)
 {
     for (size_t i = 0; i < largo; i++) {
@@ -388,6 +1639,158 @@ static void prueba_hash_iterar_volumen(size_t largo)
     hash_destruir(hash);
 }
 
+/* Suma los valores visitados; se detiene al llegar al tope. */
+typedef struct suma {
+    size_t total;
+    size_t visitados;
+    size_t tope;
+    bool largos_ok;
+} suma_t;
+
+static bool sumar(const char* clave, size_t largo, void* dato, void* extra)
+{
+    suma_t* suma = extra;
+    suma->total += *(size_t*) dato;
+    suma->largos_ok &= largo == strlen(clave);
+    return ++suma->visitados < suma->tope;
+}
+
+static void prueba_hash_iterar_pares(size_t largo)
+{
+    hash_opciones_t opciones = {0};
+    opciones.incremental = true;
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+    size_t esperado = 0;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(claves[i], i % 2 ? "%08zu" : "una clave de mas de quince, %08zu", i);
+        valores[i] = i;
+        esperado += i;
+        hash_guardar(hash, claves[i], &valores[i]);
+    }
+
+    /* Cada par coincide con lo guardado, sin buscar la clave */
+    bool ok = true;
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter), recorridos++) {
+        const char* clave;
+        size_t largo_par;
+        void* dato;
+        ok &= hash_iter_ver_par(iter, &clave, &largo_par, &dato);
+        ok &= clave == hash_iter_ver_actual(iter) && dato == hash_iter_ver_dato(iter);
+        ok &= largo_par == strlen(clave) && dato == hash_obtener(hash, clave);
+    }
+    print_test("Prueba hash iterador ver par coincide con obtener", ok && recorridos == largo);
+    print_test("Prueba hash iterador al final, ver par es false", !hash_iter_ver_par(iter, NULL, NULL, NULL));
+    print_test("Prueba hash iterador al final, ver dato es NULL", !hash_iter_ver_dato(iter));
+    hash_iter_destruir(iter);
+
+    suma_t suma = {0, 0, largo + 1, true};
+    hash_para_cada(hash, sumar, &suma);
+    print_test("Prueba hash para cada visita todos", suma.visitados == largo && suma.total == esperado);
+    print_test("Prueba hash para cada pasa el largo de la clave", suma.largos_ok);
+    suma_t corte = {0, 0, 10, true};
+    hash_para_cada(hash, sumar, &corte);
+    print_test("Prueba hash para cada se detiene", corte.visitados == 10);
+
+    /* Una clave guardada con _n conserva su largo */
+    hash_t* vacio = hash_crear(NULL);
+    size_t dato = 7;
+    hash_guardar_n(vacio, "a\0b", 3, &dato);
+    iter = hash_iter_crear(vacio);
+    size_t largo_par = 0;
+    print_test("Prueba hash iterador ver par con _n", hash_iter_ver_par(iter, NULL, &largo_par, NULL) && largo_par == 3);
+    hash_iter_destruir(iter);
+    suma_t ninguno = {0, 0, 1, true};
+    hash_borrar_n(vacio, "a\0b", 3);
+    hash_para_cada(vacio, sumar, &ninguno);
+    print_test("Prueba hash para cada en hash vacio", ninguno.visitados == 0);
+    hash_destruir(vacio);
+
+    free(valores);
+    free(claves);
+    hash_destruir(hash);
+}
+
+// Como sumar, pero en el snapshot hay datos NULL.
+static bool sumar_mapa(const char* clave, size_t largo, void* dato, void* extra)
+{
+    size_t cero = 0;
+    return sumar(clave, largo, dato ? dato : &cero, extra);
+}
+
+static void prueba_hash_snapshot(size_t largo)
+{
+    const char* ruta = "prueba_hash.snapshot";
+    hash_opciones_t opciones = {0};
+    opciones.sondeo = HASH_SONDEO_GRUPOS;
+    hash_t* hash = hash_crear_con_opciones(free, &opciones);
+
+    const size_t largo_clave = 40;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(claves[i], i % 2 ? "%08zu" : "una clave de mas de quince, %08zu", i);
+        size_t* valor = malloc(sizeof(size_t));
+        *valor = i;
+        ok &= hash_guardar(hash, claves[i], valor);
+    }
+    hash_guardar(hash, "sin dato", NULL);
+    hash_guardar_n(hash, "a\0b", 3, NULL);
+    print_test("Prueba hash snapshot guardar datos copiados", ok && hash_guardar_snapshot(hash, ruta, sizeof(size_t)));
+    hash_destruir(hash);
+
+    /* Las consultas se responden desde el archivo, sin el hash original */
+    hash_mapa_t* mapa = hash_cargar_mmap(ruta);
+    print_test("Prueba hash snapshot cargar", mapa && hash_mapa_cantidad(mapa) == largo + 2);
+    ok = mapa != NULL;
+    for (size_t i = 0; ok && i < largo; i++) {
+        size_t* valor = hash_mapa_obtener(mapa, claves[i]);
+        ok = valor != NULL && *valor == i && hash_mapa_pertenece(mapa, claves[i]);
+    }
+    print_test("Prueba hash snapshot obtener todos", ok);
+    print_test("Prueba hash snapshot dato NULL", hash_mapa_pertenece(mapa, "sin dato") && !hash_mapa_obtener(mapa, "sin dato"));
+    print_test("Prueba hash snapshot clave con _n", hash_mapa_pertenece_n(mapa, "a\0b", 3) && !hash_mapa_pertenece(mapa, "a"));
+    print_test("Prueba hash snapshot clave inexistente", !hash_mapa_pertenece(mapa, "no existe") && !hash_mapa_obtener(mapa, "no existe"));
+    suma_t suma = {0, 0, largo + 3, true};
+    hash_mapa_para_cada(mapa, sumar_mapa, &suma);
+    print_test("Prueba hash snapshot para cada", suma.visitados == largo + 2 && suma.total == largo * (largo - 1) / 2);
+    hash_mapa_cerrar(mapa);
+
+    /* Con tam_dato 0 se guarda el puntero tal cual. El snapshot usa su
+     * propia funcion de hash, asi que la del hash no importa */
+    hash_opciones_t constante = {0};
+    constante.funcion_propia = hash_constante;
+    hash = hash_crear_con_opciones(NULL, &constante);
+    for (size_t i = 0; i < largo; i++) hash_guardar(hash, claves[i], (void*) (i + 1));
+    print_test("Prueba hash snapshot guardar punteros", hash_guardar_snapshot(hash, ruta, 0));
+    hash_destruir(hash);
+    mapa = hash_cargar_mmap(ruta);
+    ok = mapa != NULL;
+    for (size_t i = 0; ok && i < largo; i++) ok = hash_mapa_obtener(mapa, claves[i]) == (void*) (i + 1);
+    print_test("Prueba hash snapshot obtener punteros", ok);
+    hash_mapa_cerrar(mapa);
+
+    /* Hash vacio y archivos que no son snapshots */
+    hash = hash_crear(NULL);
+    print_test("Prueba hash snapshot guardar hash vacio", hash_guardar_snapshot(hash, ruta, 0));
+    hash_destruir(hash);
+    mapa = hash_cargar_mmap(ruta);
+    print_test("Prueba hash snapshot cargar hash vacio", mapa && hash_mapa_cantidad(mapa) == 0 && !hash_mapa_pertenece(mapa, ""));
+    hash_mapa_cerrar(mapa);
+    FILE* archivo = fopen(ruta, "r+b");
+    fputc('X', archivo);
+    fclose(archivo);
+    print_test("Prueba hash snapshot cargar archivo invalido es NULL", !hash_cargar_mmap(ruta));
+    remove(ruta);
+    print_test("Prueba hash snapshot cargar archivo inexistente es NULL", !hash_cargar_mmap(ruta));
+    free(claves);
+}
+
 /* ******************************************************************
  *                        FUNCIÓN PRINCIPAL
  * *****************************************************************/
@@ -412,12 +1815,56 @@ void pruebas_hash_catedra()
     prueba_hash_clave_vacia();
     printf("Prueba Hash valor null\n\n");
     prueba_hash_valor_null();
+    printf("Prueba Hash obtener o insertar\n\n");
+    prueba_hash_obtener_o_insertar();
+    printf("Prueba Hash claves con largo\n\n");
+    prueba_hash_claves_n();
+    printf("Prueba Hash claves largas\n\n");
+    prueba_hash_claves_largas(2000);
     printf("Prueba Hash volumen\n\n");
-    prueba_hash_volumen(500, true); //Hay problemas al hash_redimensionar
+    prueba_hash_volumen(500, true);
+    printf("Prueba Hash borrar y reinsertar\n\n");
+    prueba_hash_borrar_y_reinsertar(500, NULL);
+    printf("Prueba Hash Robin Hood\n\n");
+    prueba_hash_robin_hood(500);
+    printf("Prueba Hash sondeo por grupos\n\n");
+    prueba_hash_grupos(500);
+    printf("Prueba Hash redimensionado incremental\n\n");
+    prueba_hash_incremental(500);
+    printf("Prueba Hash capacidad y lote\n\n");
+    prueba_hash_capacidad(1000);
+    printf("Prueba Hash busquedas en lote\n\n");
+    prueba_hash_lote(500);
+    printf("Prueba Hash sharded\n\n");
+    prueba_hash_sharded(5000);
+    printf("Prueba Hash con hash calculado\n\n");
+    prueba_hash_con_hash(5000);
+    printf("Prueba Hash operaciones en paralelo\n\n");
+    prueba_hash_paralelo(100000);
+    printf("Prueba Hash estadisticas\n\n");
+    prueba_hash_estadisticas(5000);
+    printf("Prueba Hash recompactar borrados\n\n");
+    prueba_hash_recompactar(1000);
+    printf("Prueba Hash generico\n\n");
+    prueba_hash_generico(5000);
+    printf("Prueba Hash set\n\n");
+    prueba_hash_set(5000);
+    printf("Prueba Hash congelado\n\n");
+    prueba_hash_congelar(5000);
+    printf("Prueba Hash iteradores de rango\n\n");
+    prueba_hash_rangos(5000);
+    printf("Prueba Hash funciones de hash\n\n");
+    prueba_hash_funciones(500);
+    printf("Prueba Hash allocator\n\n");
+    prueba_hash_allocator(5000);
     printf("Prueba Hash iterar\n\n");
     prueba_hash_iterar();
     printf("Prueba Hash iterar volumen\n\n");
     prueba_hash_iterar_volumen(500);
+    printf("Prueba Hash iterar pares\n\n");
+    prueba_hash_iterar_pares(500);
+    printf("Prueba Hash snapshot\n\n");
+    prueba_hash_snapshot(5000);
 }
 
 void pruebas_volumen_catedra(size_t largo)
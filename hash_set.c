@@ -0,0 +1,364 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_set.h"
+#include "hash_interno.h"
+#include "hash_arena.h"
+
+#define OCUPADO 1
+#define BORRADO 2
+#define VACIO 0
+#define NO_ENCONTRADO ((size_t)-1)
+/* ******************************************************************
+ *                           STRUCTS
+ * *****************************************************************/
+
+typedef struct elemento{
+  uint64_t hash;      // hash completo de la clave, se compara antes que la clave
+  union{
+    char corta[HASH_CLAVE_CORTA + 1];
+    char* larga;      // en la arena, largo bytes mas un '\0'
+  }clave;
+  uint32_t largo;
+  uint32_t estado;
+}elemento_t;
+
+struct hash_set{
+  hash_allocator_t allocator;
+  elemento_t* elementos;
+  size_t capacidad;        // siempre potencia de dos
+  size_t mascara;          // capacidad - 1
+  unsigned desplazamiento; // 64 - log2(capacidad)
+  size_t cantidad;
+  size_t borrados;
+  size_t reservada;        // capacidad por debajo de la cual no se achica
+  hash_funcion_hash_t funcion_hash;
+  uint64_t semilla;
+  arena_t arena;           // claves largas
+};
+
+/* ******************************************************************
+ *                      FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Toda la memoria del conjunto se pide y se devuelve por su allocator. */
+
+static void* set_pedir(const hash_set_t* set, size_t tam){
+  return set->allocator.pedir(set->allocator.contexto, tam);
+}
+
+static void set_liberar(const hash_set_t* set, void* ptr, size_t tam){
+  if (ptr != NULL) set->allocator.liberar(set->allocator.contexto, ptr, tam);
+}
+
+static uint64_t set_hash(const hash_set_t* set, const char* clave, size_t largo){
+  return set->funcion_hash(clave, largo, set->semilla);
+}
+
+static size_t set_posicion(const hash_set_t* set, uint64_t h){
+  return (size_t)((h * HASH_FIBONACCI) >> set->desplazamiento);
+}
+
+/* Capacidad en la que entran n claves sin redimensionar, la misma que
+ * reserva hash_t para n elementos.
+ */
+static size_t set_capacidad_para(size_t n){
+  size_t tam = hash_capacidad_para(n);
+  return tam > hash_capacidad_inicial() ? tam : hash_capacidad_inicial();
+}
+
+static void set_fijar_capacidad(hash_set_t* set, size_t tam){
+  set->capacidad = tam;
+  set->mascara = tam - 1;
+  set->desplazamiento = 64;
+  for (size_t t = tam; t > 1; t >>= 1) set->desplazamiento--;
+}
+
+static elemento_t* elementos_crear(const hash_set_t* set, size_t tam){
+  elemento_t* elementos = set_pedir(set, tam * sizeof(elemento_t));
+  if (elementos != NULL) memset(elementos, 0, tam * sizeof(elemento_t));
+  return elementos;
+}
+
+static const char* elemento_clave(const elemento_t* elemento){
+  return elemento->largo <= HASH_CLAVE_CORTA ? elemento->clave.corta : elemento->clave.larga;
+}
+
+static inline bool elemento_clave_igual(const elemento_t* elemento, uint64_t h, const char* clave, size_t largo){
+  return elemento->hash == h && elemento->largo == largo && memcmp(elemento_clave(elemento), clave, largo) == 0;
+}
+
+HASH_DEFINIR_UBICAR_LINEAL(set_ubicar, hash_set_t, elemento_t, elementos, VACIO, BORRADO, elemento_clave_igual)
+
+/* Ubica el elemento, que no esta en el conjunto, en la primera posicion
+ * libre de su sondeo.
+ */
+static void set_reinsertar(hash_set_t* set, elemento_t elemento){
+  size_t pos = set_posicion(set, elemento.hash);
+  while (set->elementos[pos].estado == OCUPADO) pos = (pos + 1) & set->mascara;
+  if (set->elementos[pos].estado == BORRADO) set->borrados--;
+  set->elementos[pos] = elemento;
+}
+
+/* Arma un elemento con una copia de clave: dentro del elemento si es
+ * corta, en la arena si no.
+ */
+static bool elemento_crear(hash_set_t* set, elemento_t* elemento, const char* clave, size_t largo, uint64_t h){
+  if (largo > UINT32_MAX) return false;
+  elemento->hash = h;
+  elemento->largo = (uint32_t)largo;
+  elemento->estado = OCUPADO;
+  char* destino = elemento->clave.corta;
+  if (largo > HASH_CLAVE_CORTA){
+    destino = arena_pedir(&set->arena, largo + 1);
+    if (destino == NULL) return false;
+    elemento->clave.larga = destino;
+  }
+  memcpy(destino, clave, largo);
+  destino[largo] = '\0';
+  return true;
+}
+
+static void elemento_liberar(hash_set_t* set, const elemento_t* elemento){
+  if (elemento->largo > HASH_CLAVE_CORTA) arena_devolver(&set->arena, elemento->largo + 1);
+}
+
+/* Copia las claves largas vivas a una arena de un solo bloque, como
+ * arena_compactar en hash.c. Si no hay memoria la deja como estaba.
+ */
+static void set_compactar_arena(hash_set_t* set){
+  arena_t nueva;
+  if (!arena_compactar_iniciar(&set->arena, &nueva)) return;
+  for (size_t i=0; i<set->capacidad; i++){
+    elemento_t* elemento = &set->elementos[i];
+    if (elemento->estado != OCUPADO || elemento->largo <= HASH_CLAVE_CORTA) continue;
+    elemento->clave.larga = arena_mudar(&nueva, elemento->clave.larga, elemento->largo + 1);
+  }
+  arena_compactar_terminar(&set->arena, &nueva);
+}
+
+/* Pasa las claves a una tabla de tam posiciones, sin BORRADO. Con tam
+ * igual a la capacidad solo limpia los BORRADO. Las claves largas quedan
+ * donde estaban en la arena.
+ */
+static bool set_redimensionar(hash_set_t* set, size_t tam){
+  elemento_t* elementos = elementos_crear(set, tam);
+  if (elementos == NULL) return false;
+  elemento_t* viejos = set->elementos;
+  size_t capacidad_vieja = set->capacidad;
+  set->elementos = elementos;
+  set->borrados = 0;
+  set_fijar_capacidad(set, tam);
+  for (size_t i=0; i<capacidad_vieja; i++){
+    if (viejos[i].estado == OCUPADO) set_reinsertar(set, viejos[i]);
+  }
+  set_liberar(set, viejos, capacidad_vieja * sizeof(elemento_t));
+  return true;
+}
+
+/* Crea un conjunto vacio con lugar para n claves sin redimensionar. Si
+ * semilla es 0 elige una al azar.
+ */
+static hash_set_t* set_crear(size_t n, const hash_allocator_t* allocator, hash_funcion_hash_t funcion_hash, uint64_t semilla){
+  hash_set_t* set = allocator->pedir(allocator->contexto, sizeof(hash_set_t));
+  if (set == NULL) return NULL;
+  set->allocator = *allocator;
+  set_fijar_capacidad(set, set_capacidad_para(n));
+  set->elementos = elementos_crear(set, set->capacidad);
+  if (set->elementos == NULL){
+    allocator->liberar(allocator->contexto, set, sizeof(hash_set_t));
+    return NULL;
+  }
+  set->cantidad = 0;
+  set->borrados = 0;
+  set->reservada = 0;
+  set->funcion_hash = funcion_hash;
+  set->semilla = semilla != 0 ? semilla : hash_semilla_aleatoria(set);
+  arena_crear(&set->arena, &set->allocator);
+  return set;
+}
+
+/* Crea el resultado de una operacion con la funcion de hash, la semilla y
+ * el allocator de modelo, con lugar para n claves.
+ */
+static hash_set_t* set_crear_como(const hash_set_t* modelo, size_t n){
+  return set_crear(n, &modelo->allocator, modelo->funcion_hash, modelo->semilla);
+}
+
+/* Calcula el hash en set del elemento de origen. Si usan la misma funcion
+ * y la misma semilla no lo recalcula.
+ */
+static uint64_t set_hash_de(const hash_set_t* set, const hash_set_t* origen, const elemento_t* elemento){
+  if (set->semilla == origen->semilla && set->funcion_hash == origen->funcion_hash) return elemento->hash;
+  return set_hash(set, elemento_clave(elemento), elemento->largo);
+}
+
+/* Agrega a set una copia del elemento de origen, que no esta en set y
+ * entra sin redimensionar.
+ */
+static bool set_agregar_de(hash_set_t* set, const hash_set_t* origen, const elemento_t* elemento){
+  elemento_t copia;
+  if (!elemento_crear(set, &copia, elemento_clave(elemento), elemento->largo, set_hash_de(set, origen, elemento))) return false;
+  set_reinsertar(set, copia);
+  set->cantidad++;
+  return true;
+}
+
+/* Determina si el elemento de origen pertenece a set. */
+static bool set_contiene(const hash_set_t* set, const hash_set_t* origen, const elemento_t* elemento){
+  bool encontrado;
+  set_ubicar(set, elemento_clave(elemento), elemento->largo, set_hash_de(set, origen, elemento), &encontrado);
+  return encontrado;
+}
+
+/* Agrega al resultado los elementos de origen que estan (o no estan, segun
+ * pertenecer) en otro. Si otro es NULL los agrega todos.
+ */
+static bool set_filtrar(hash_set_t* resultado, const hash_set_t* origen, const hash_set_t* otro, bool pertenecer){
+  for (size_t i=0; i<origen->capacidad; i++){
+    const elemento_t* elemento = &origen->elementos[i];
+    if (elemento->estado != OCUPADO) continue;
+    if (otro != NULL && set_contiene(otro, origen, elemento) != pertenecer) continue;
+    if (!set_agregar_de(resultado, origen, elemento)) return false;
+  }
+  return true;
+}
+
+/* ******************************************************************
+ *                       PRIMITIVAS DEL CONJUNTO
+ * *****************************************************************/
+
+hash_set_t *hash_set_crear(void){
+  return hash_set_crear_con_opciones(NULL);
+}
+
+hash_set_t *hash_set_crear_con_opciones(const hash_opciones_t *opciones){
+  hash_opciones_t por_omision = {0};
+  if (opciones == NULL) opciones = &por_omision;
+  const hash_allocator_t* allocator = opciones->allocator ? opciones->allocator : &HASH_ALLOCATOR_MALLOC;
+  hash_funcion_hash_t funcion_hash = fhash_rapida;
+  if (opciones->funcion_propia != NULL){
+    funcion_hash = opciones->funcion_propia;
+  } else if (opciones->funcion == HASH_FUNCION_CLASICA){
+    funcion_hash = fhash;
+  }
+  hash_set_t* set = set_crear(opciones->capacidad, allocator, funcion_hash, opciones->semilla);
+  if (set != NULL && opciones->capacidad > 0) set->reservada = set->capacidad;
+  return set;
+}
+
+bool hash_set_guardar(hash_set_t *set, const char *clave){
+  return hash_set_guardar_n(set, clave, strlen(clave));
+}
+
+bool hash_set_guardar_n(hash_set_t *set, const char *clave, size_t largo){
+  bool encontrado;
+  uint64_t h = set_hash(set, clave, largo);
+  size_t pos = set_ubicar(set, clave, largo, h, &encontrado);
+  if (encontrado) return true;
+  // Los BORRADO cuentan en la carga, como en hash_t.
+  if (((double)(set->cantidad + set->borrados))/(double)set->capacidad >= HASH_CARGA_MAX || pos == NO_ENCONTRADO){
+    size_t tam = (double)set->borrados >= HASH_BORRADOS_MAX * (double)set->capacidad ? set->capacidad : set->capacidad * 2;
+    if (set_redimensionar(set, tam)) pos = set_ubicar(set, clave, largo, h, &encontrado);
+    if (pos == NO_ENCONTRADO) return false;
+  }
+  elemento_t elemento;
+  if (!elemento_crear(set, &elemento, clave, largo, h)) return false;
+  if (set->elementos[pos].estado == BORRADO) set->borrados--;
+  set->elementos[pos] = elemento;
+  set->cantidad++;
+  return true;
+}
+
+bool hash_set_borrar(hash_set_t *set, const char *clave){
+  return hash_set_borrar_n(set, clave, strlen(clave));
+}
+
+bool hash_set_borrar_n(hash_set_t *set, const char *clave, size_t largo){
+  bool encontrado;
+  uint64_t h = set_hash(set, clave, largo);
+  size_t pos = set_ubicar(set, clave, largo, h, &encontrado);
+  if (!encontrado) return false;
+  elemento_liberar(set, &set->elementos[pos]);
+  set->elementos[pos].estado = BORRADO;
+  set->borrados++;
+  set->cantidad--;
+  size_t minima = set->reservada > hash_capacidad_inicial() ? set->reservada : hash_capacidad_inicial();
+  if ((double)set->cantidad/(double)set->capacidad <= HASH_CARGA_MIN && set->capacidad/2 >= minima){
+    set_redimensionar(set, set->capacidad/2);
+  }
+  if (arena_hay_que_compactar(&set->arena)) set_compactar_arena(set);
+  return true;
+}
+
+bool hash_set_pertenece(const hash_set_t *set, const char *clave){
+  return hash_set_pertenece_n(set, clave, strlen(clave));
+}
+
+bool hash_set_pertenece_n(const hash_set_t *set, const char *clave, size_t largo){
+  bool encontrado;
+  set_ubicar(set, clave, largo, set_hash(set, clave, largo), &encontrado);
+  return encontrado;
+}
+
+size_t hash_set_cantidad(const hash_set_t *set){
+  return set->cantidad;
+}
+
+void hash_set_para_cada(const hash_set_t *set, bool visitar(const char *clave, size_t largo, void *extra), void *extra){
+  for (size_t i=0; i<set->capacidad; i++){
+    const elemento_t* elemento = &set->elementos[i];
+    if (elemento->estado != OCUPADO) continue;
+    if (!visitar(elemento_clave(elemento), elemento->largo, extra)) return;
+  }
+}
+
+/* El resultado usa la funcion de hash, la semilla y el allocator de a: los
+ * hashes guardados en a se copian sin recalcular, y las operaciones
+ * encadenadas sobre resultados tampoco recalculan.
+ */
+hash_set_t *hash_set_union(const hash_set_t *a, const hash_set_t *b){
+  hash_set_t* resultado = set_crear_como(a, a->cantidad + b->cantidad);
+  if (resultado == NULL) return NULL;
+  if (!set_filtrar(resultado, a, NULL, true) || !set_filtrar(resultado, b, a, false)){
+    hash_set_destruir(resultado);
+    return NULL;
+  }
+  return resultado;
+}
+
+hash_set_t *hash_set_interseccion(const hash_set_t *a, const hash_set_t *b){
+  // Se recorre el menor y se busca en el mayor
+  const hash_set_t* menor = a->cantidad <= b->cantidad ? a : b;
+  const hash_set_t* mayor = menor == a ? b : a;
+  hash_set_t* resultado = set_crear_como(a, menor->cantidad);
+  if (resultado == NULL) return NULL;
+  if (!set_filtrar(resultado, menor, mayor, true)){
+    hash_set_destruir(resultado);
+    return NULL;
+  }
+  return resultado;
+}
+
+hash_set_t *hash_set_diferencia(const hash_set_t *a, const hash_set_t *b){
+  hash_set_t* resultado = set_crear_como(a, a->cantidad);
+  if (resultado == NULL) return NULL;
+  if (!set_filtrar(resultado, a, b, false)){
+    hash_set_destruir(resultado);
+    return NULL;
+  }
+  return resultado;
+}
+
+size_t hash_set_memoria(const hash_set_t *set){
+  return sizeof(hash_set_t) + set->capacidad * sizeof(elemento_t) + set->arena.reservado;
+}
+
+void hash_set_destruir(hash_set_t *set){
+  arena_destruir(&set->arena);
+  set_liberar(set, set->elementos, set->capacidad * sizeof(elemento_t));
+  hash_allocator_t allocator = set->allocator;
+  allocator.liberar(allocator.contexto, set, sizeof(hash_set_t));
+}
@@ -0,0 +1,79 @@
+#ifndef HASH_SET_H
+#define HASH_SET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Conjunto de claves: un hash sin datos, para cuando solo se pregunta si
+ * una clave pertenece. Usa el mismo sondeo lineal que hash_t, con sus
+ * cargas, su arena para las claves largas y su allocator, pero cada
+ * posición guarda solo el hash, la clave (las cortas adentro) y su largo:
+ * ocupa 32 bytes en lugar de 48, y entran más claves por línea de caché.
+ */
+struct hash_set;
+typedef struct hash_set hash_set_t;
+
+/* Crea el conjunto vacío. Devuelve NULL si no hay memoria.
+ */
+hash_set_t *hash_set_crear(void);
+
+/* Crea el conjunto con las opciones de hash_crear_con_opciones (opciones
+ * puede ser NULL). Se usan funcion, funcion_propia, semilla, allocator y
+ * capacidad; el conjunto siempre sondea en forma lineal, así que sondeo,
+ * incremental, hilos y destruir_en_paralelo no tienen efecto.
+ */
+hash_set_t *hash_set_crear_con_opciones(const hash_opciones_t *opciones);
+
+/* Agrega una copia de clave. Devuelve false si no hay memoria; agregar una
+ * clave que ya estaba no cambia nada.
+ * Pre: El conjunto fue creado
+ */
+bool hash_set_guardar(hash_set_t *set, const char *clave);
+bool hash_set_guardar_n(hash_set_t *set, const char *clave, size_t largo);
+
+/* Saca clave del conjunto. Devuelve false si no estaba.
+ * Pre: El conjunto fue creado
+ */
+bool hash_set_borrar(hash_set_t *set, const char *clave);
+bool hash_set_borrar_n(hash_set_t *set, const char *clave, size_t largo);
+
+/* Determina si clave pertenece al conjunto.
+ * Pre: El conjunto fue creado
+ */
+bool hash_set_pertenece(const hash_set_t *set, const char *clave);
+bool hash_set_pertenece_n(const hash_set_t *set, const char *clave, size_t largo);
+
+/* Devuelve la cantidad de claves del conjunto.
+ * Pre: El conjunto fue creado
+ */
+size_t hash_set_cantidad(const hash_set_t *set);
+
+/* Llama a visitar con cada clave, en un orden cualquiera, hasta que
+ * devuelva false. visitar no puede modificar el conjunto.
+ * Pre: El conjunto fue creado
+ */
+void hash_set_para_cada(const hash_set_t *set, bool visitar(const char *clave, size_t largo, void *extra), void *extra);
+
+/* Operaciones de conjuntos: devuelven un conjunto nuevo con las claves
+ * que están en a o en b, en a y en b, o en a y no en b. Recorren las dos
+ * tablas una vez; el resultado se reserva de entrada y no se redimensiona.
+ * El resultado usa la función de hash, la semilla y el allocator de a.
+ * Devuelven NULL si no hay memoria.
+ * Pre: Los conjuntos fueron creados
+ */
+hash_set_t *hash_set_union(const hash_set_t *a, const hash_set_t *b);
+hash_set_t *hash_set_interseccion(const hash_set_t *a, const hash_set_t *b);
+hash_set_t *hash_set_diferencia(const hash_set_t *a, const hash_set_t *b);
+
+/* Devuelve los bytes que ocupa el conjunto, incluidas las claves largas.
+ * Pre: El conjunto fue creado
+ */
+size_t hash_set_memoria(const hash_set_t *set);
+
+/* Destruye el conjunto y sus claves.
+ * Pre: El conjunto fue creado
+ */
+void hash_set_destruir(hash_set_t *set);
+
+#endif // HASH_SET_H
@@ -0,0 +1,215 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_sharded.h"
+#include "hash_interno.h"
+
+#define SHARDS_POR_OMISION 16
+#define LINEA_CACHE 64
+/* ******************************************************************
+ *                           STRUCTS
+ * *****************************************************************/
+
+typedef struct shard{
+  pthread_rwlock_t lock;
+  hash_t* hash;
+}shard_t;
+
+// Cada shard ocupa sus propias lineas de cache: el lock de uno no se
+// invalida cuando otro hilo toma el del vecino.
+typedef union shard_alineado{
+  shard_t shard;
+  char relleno[(sizeof(shard_t) + LINEA_CACHE - 1) / LINEA_CACHE * LINEA_CACHE];
+}shard_alineado_t;
+
+// Todos los shards usan la misma funcion y semilla: el hash de una clave
+// se calcula una vez, elige el shard y se pasa a las primitivas _con_hash.
+struct hash_sharded{
+  shard_alineado_t* shards;
+  size_t cantidad_shards;  // potencia de dos
+  unsigned bits;           // log2(cantidad_shards)
+};
+
+struct hash_sharded_iter{
+  const hash_sharded_t* hash;
+  size_t shard;
+  hash_iter_t* iter;       // iterador del shard actual
+};
+
+/* ******************************************************************
+ *                      FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Hash de la clave, el mismo en todos los shards. La funcion y la semilla
+ * no cambian despues de crear los shards, asi que no hace falta lock.
+ */
+static inline uint64_t sharded_hash(const hash_sharded_t* hash, const char* clave, size_t largo){
+  return hash_hash_clave(hash->shards[0].shard.hash, clave, largo);
+}
+
+/* Elige el shard con los bits altos de h mezclado con xorshift y una
+ * multiplicacion: dentro del shard la posicion sale de h*FIBONACCI, y sin
+ * la mezcla las claves de un mismo shard compartirian esos bits.
+ */
+static inline shard_t* shard_de(const hash_sharded_t* hash, uint64_t h){
+  if (hash->bits == 0) return &hash->shards[0].shard;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return &hash->shards[h >> (64 - hash->bits)].shard;
+}
+
+/* Avanza iter->shard hasta uno que tenga elementos, o hasta el ultimo.
+ * Devuelve false si no pudo crear el iterador de un shard; en ese caso el
+ * iterador queda como estaba.
+ */
+static bool sharded_iter_saltar_vacios(hash_sharded_iter_t* iter){
+  while (hash_iter_al_final(iter->iter) && iter->shard + 1 < iter->hash->cantidad_shards){
+    hash_iter_t* siguiente = hash_iter_crear(iter->hash->shards[iter->shard + 1].shard.hash);
+    if (siguiente == NULL) return false;
+    hash_iter_destruir(iter->iter);
+    iter->shard++;
+    iter->iter = siguiente;
+  }
+  return true;
+}
+
+/* ******************************************************************
+ *                       PRIMITIVAS DEL HASH
+ * *****************************************************************/
+
+hash_sharded_t *hash_sharded_crear(size_t shards, hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones){
+  if (shards == 0) shards = SHARDS_POR_OMISION;
+  hash_sharded_t* hash = malloc(sizeof(hash_sharded_t));
+  if (hash == NULL) return NULL;
+  hash->cantidad_shards = 1;
+  hash->bits = 0;
+  while (hash->cantidad_shards < shards){
+    hash->cantidad_shards <<= 1;
+    hash->bits++;
+  }
+  void* memoria;
+  if (posix_memalign(&memoria, LINEA_CACHE, hash->cantidad_shards * sizeof(shard_alineado_t)) != 0){
+    free(hash);
+    return NULL;
+  }
+  hash->shards = memoria;
+  hash_opciones_t comunes = {0};
+  if (opciones != NULL) comunes = *opciones;
+  if (comunes.semilla == 0) comunes.semilla = hash_semilla_aleatoria(hash) | 1;
+  for (size_t i=0; i<hash->cantidad_shards; i++){
+    shard_t* shard = &hash->shards[i].shard;
+    shard->hash = hash_crear_con_opciones(destruir_dato, &comunes);
+    if (shard->hash == NULL){
+      hash->cantidad_shards = i;
+      hash_sharded_destruir(hash);
+      return NULL;
+    }
+    pthread_rwlock_init(&shard->lock, NULL);
+  }
+  return hash;
+}
+
+bool hash_sharded_guardar(hash_sharded_t *hash, const char *clave, void *dato){
+  size_t largo = strlen(clave);
+  uint64_t h = sharded_hash(hash, clave, largo);
+  shard_t* shard = shard_de(hash, h);
+  pthread_rwlock_wrlock(&shard->lock);
+  bool ok = hash_guardar_con_hash(shard->hash, clave, largo, h, dato);
+  pthread_rwlock_unlock(&shard->lock);
+  return ok;
+}
+
+void *hash_sharded_borrar(hash_sharded_t *hash, const char *clave){
+  size_t largo = strlen(clave);
+  uint64_t h = sharded_hash(hash, clave, largo);
+  shard_t* shard = shard_de(hash, h);
+  pthread_rwlock_wrlock(&shard->lock);
+  void* dato = hash_borrar_con_hash(shard->hash, clave, largo, h);
+  pthread_rwlock_unlock(&shard->lock);
+  return dato;
+}
+
+void *hash_sharded_obtener(const hash_sharded_t *hash, const char *clave){
+  size_t largo = strlen(clave);
+  uint64_t h = sharded_hash(hash, clave, largo);
+  shard_t* shard = shard_de(hash, h);
+  pthread_rwlock_rdlock(&shard->lock);
+  void* dato = hash_obtener_con_hash(shard->hash, clave, largo, h);
+  pthread_rwlock_unlock(&shard->lock);
+  return dato;
+}
+
+bool hash_sharded_pertenece(const hash_sharded_t *hash, const char *clave){
+  size_t largo = strlen(clave);
+  uint64_t h = sharded_hash(hash, clave, largo);
+  shard_t* shard = shard_de(hash, h);
+  pthread_rwlock_rdlock(&shard->lock);
+  bool pertenece = hash_pertenece_con_hash(shard->hash, clave, largo, h);
+  pthread_rwlock_unlock(&shard->lock);
+  return pertenece;
+}
+
+size_t hash_sharded_cantidad(const hash_sharded_t *hash){
+  size_t cantidad = 0;
+  for (size_t i=0; i<hash->cantidad_shards; i++){
+    shard_t* shard = &hash->shards[i].shard;
+    pthread_rwlock_rdlock(&shard->lock);
+    cantidad += hash_cantidad(shard->hash);
+    pthread_rwlock_unlock(&shard->lock);
+  }
+  return cantidad;
+}
+
+void hash_sharded_destruir(hash_sharded_t *hash){
+  for (size_t i=0; i<hash->cantidad_shards; i++){
+    pthread_rwlock_destroy(&hash->shards[i].shard.lock);
+    hash_destruir(hash->shards[i].shard.hash);
+  }
+  free(hash->shards);
+  free(hash);
+}
+
+/* ******************************************************************
+ *                       PRIMITIVAS DEL ITERADOR
+ * *****************************************************************/
+
+hash_sharded_iter_t *hash_sharded_iter_crear(const hash_sharded_t *hash){
+  hash_sharded_iter_t* iter = malloc(sizeof(hash_sharded_iter_t));
+  if (iter == NULL) return NULL;
+  iter->hash = hash;
+  iter->shard = 0;
+  iter->iter = hash_iter_crear(hash->shards[0].shard.hash);
+  if (iter->iter == NULL){
+    free(iter);
+    return NULL;
+  }
+  if (!sharded_iter_saltar_vacios(iter)){
+    hash_sharded_iter_destruir(iter);
+    return NULL;
+  }
+  return iter;
+}
+
+bool hash_sharded_iter_avanzar(hash_sharded_iter_t *iter){
+  if (!hash_iter_avanzar(iter->iter)) return false;
+  return sharded_iter_saltar_vacios(iter);
+}
+
+const char *hash_sharded_iter_ver_actual(const hash_sharded_iter_t *iter){
+  return hash_iter_ver_actual(iter->iter);
+}
+
+bool hash_sharded_iter_al_final(const hash_sharded_iter_t *iter){
+  return hash_iter_al_final(iter->iter);
+}
+
+void hash_sharded_iter_destruir(hash_sharded_iter_t *iter){
+  hash_iter_destruir(iter->iter);
+  free(iter);
+}
@@ -0,0 +1,62 @@
+#ifndef HASH_SHARDED_H
+#define HASH_SHARDED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Hash repartido en varios hash_t independientes ("shards"), cada uno con
+ * su propio lock de lectura/escritura. Todos los shards usan la misma
+ * función y semilla: el hash de la clave se calcula una sola vez, sus
+ * bits (mezclados) eligen el shard, y dentro de él se usa el mismo valor
+ * con las primitivas _con_hash de hash_t. Los hilos que tocan shards
+ * distintos no se esperan entre sí, y varias lecturas del mismo shard
+ * tampoco.
+ */
+struct hash_sharded;
+struct hash_sharded_iter;
+
+typedef struct hash_sharded hash_sharded_t;
+typedef struct hash_sharded_iter hash_sharded_iter_t;
+
+/* Crea el hash con shards shards (se redondea a potencia de dos; 0 usa
+ * 16), cada uno creado con opciones, que puede ser NULL. Si las opciones
+ * no traen semilla se elige una al azar, la misma para todos los shards.
+ * Si traen un allocator, este tiene que admitir llamadas desde varios
+ * hilos. Devuelve NULL si no pudo crearlo.
+ */
+hash_sharded_t *hash_sharded_crear(size_t shards, hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+/* Primitivas equivalentes a las de hash_t. Se pueden llamar desde varios
+ * hilos a la vez; el dato que devuelven obtener y borrar sigue siendo del
+ * usuario.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_sharded_guardar(hash_sharded_t *hash, const char *clave, void *dato);
+void *hash_sharded_borrar(hash_sharded_t *hash, const char *clave);
+void *hash_sharded_obtener(const hash_sharded_t *hash, const char *clave);
+bool hash_sharded_pertenece(const hash_sharded_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos de todos los shards. Cada shard se
+ * cuenta con su lock por separado: si otros hilos están modificando el
+ * hash, el resultado es aproximado.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_sharded_cantidad(const hash_sharded_t *hash);
+
+/* Destruye el hash y todos sus shards.
+ * Pre: ningún otro hilo lo está usando.
+ */
+void hash_sharded_destruir(hash_sharded_t *hash);
+
+/* Iterador: recorre los shards uno detrás de otro. Igual que con hash_t,
+ * el hash no se puede modificar mientras se itera. Crear devuelve NULL, y
+ * avanzar false, si no hay memoria para el iterador del shard siguiente.
+ */
+hash_sharded_iter_t *hash_sharded_iter_crear(const hash_sharded_t *hash);
+bool hash_sharded_iter_avanzar(hash_sharded_iter_t *iter);
+const char *hash_sharded_iter_ver_actual(const hash_sharded_iter_t *iter);
+bool hash_sharded_iter_al_final(const hash_sharded_iter_t *iter);
+void hash_sharded_iter_destruir(hash_sharded_iter_t *iter);
+
+#endif // HASH_SHARDED_H
@@ -0,0 +1,365 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash_snapshot.h"
+#include "hash_interno.h"
+
+#define SNAPSHOT_MAGIA "HASHSNP1"
+#define SNAPSHOT_VERSION 1
+// Se guarda para detectar un archivo de una maquina con otro orden de bytes.
+#define SNAPSHOT_ORDEN 0x0102030405060708ull
+#define SNAPSHOT_VACIO 0
+#define SNAPSHOT_OCUPADO 1
+// Sufijo del temporal que se renombra a la ruta pedida (ver mkstemp).
+#define SNAPSHOT_TEMPORAL ".XXXXXX"
+// Permisos del archivo escrito: todos lo leen, solo su usuario lo escribe.
+#define SNAPSHOT_PERMISOS (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
+// Dato NULL en un snapshot con datos copiados.
+#define SNAPSHOT_SIN_DATO UINT64_MAX
+// Como en hash_t, pero el mapa no crece: se arma a lo sumo a medio llenar
+// para que los sondeos lineales sean cortos.
+#define SNAPSHOT_CAPACIDAD_MIN 2
+/* ******************************************************************
+ *                           STRUCTS
+ * *****************************************************************/
+
+/* Formato del archivo: cabecera, campos, claves y datos, en ese orden.
+ * Todas las referencias son desplazamientos desde el comienzo de su
+ * seccion, asi el archivo se puede mapear en cualquier direccion.
+ */
+typedef struct snapshot_cabecera{
+  char magia[8];
+  uint32_t version;
+  uint32_t tam_campo;     // sizeof(snapshot_campo_t)
+  uint64_t orden;         // SNAPSHOT_ORDEN
+  uint64_t capacidad;     // potencia de dos
+  uint64_t cantidad;
+  uint64_t semilla;       // de fhash_rapida
+  uint64_t tam_dato;      // 0: los datos son el valor del puntero
+  uint64_t inicio_campos;
+  uint64_t inicio_claves;
+  uint64_t tam_claves;
+  uint64_t inicio_datos;
+  uint64_t tam_datos;
+}snapshot_cabecera_t;
+
+typedef struct snapshot_campo{
+  uint64_t hash;
+  uint64_t clave;         // desplazamiento en la seccion de claves
+  uint64_t dato;          // desplazamiento en la de datos, o el puntero
+  uint32_t largo;
+  uint32_t estado;
+}snapshot_campo_t;
+
+struct hash_mapa{
+  void* mapeo;
+  size_t tam_mapeo;
+  const snapshot_campo_t* campos;
+  const char* claves;
+  char* datos;            // el mapeo es de solo lectura, ver hash_mapa_obtener
+  size_t mascara;
+  unsigned desplazamiento;
+  size_t cantidad;
+  uint64_t semilla;
+  uint64_t tam_claves;
+  uint64_t tam_datos;
+  uint64_t tam_dato;
+};
+
+// Lo que se va armando en memoria antes de escribir el archivo.
+typedef struct snapshot_escritura{
+  snapshot_campo_t* campos;
+  size_t mascara;
+  unsigned desplazamiento;
+  uint64_t semilla;
+  char* claves;
+  size_t tam_claves;
+  size_t reservado_claves;
+  char* datos;
+  size_t tam_datos;
+  size_t reservado_datos;
+  size_t tam_dato;
+  bool ok;
+}snapshot_escritura_t;
+
+/* ******************************************************************
+ *                      FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Redondea para que cada dato copiado quede alineado a 8 bytes.
+static size_t snapshot_alinear(size_t tam){
+  return (tam + 7) & ~(size_t)7;
+}
+
+/* Agrega tam bytes al buffer, agrandandolo al doble si hace falta, y
+ * devuelve el desplazamiento donde quedaron.
+ */
+static bool snapshot_agregar(char** buffer, size_t* usado, size_t* reservado, const void* bytes, size_t tam, size_t* desplazamiento){
+  if (*usado + tam > *reservado){
+    size_t nuevo = *reservado ? *reservado : 4096;
+    while (*usado + tam > nuevo) nuevo *= 2;
+    char* agrandado = realloc(*buffer, nuevo);
+    if (agrandado == NULL) return false;
+    *buffer = agrandado;
+    *reservado = nuevo;
+  }
+  memcpy(*buffer + *usado, bytes, tam);
+  *desplazamiento = *usado;
+  *usado += tam;
+  return true;
+}
+
+/* Ubica un elemento en la tabla del snapshot, por sondeo lineal desde la
+ * posicion que indican los bits altos de su hash.
+ */
+static bool snapshot_ubicar(const char* clave, size_t largo, void* dato, void* extra){
+  snapshot_escritura_t* escritura = extra;
+  uint64_t h = fhash_rapida(clave, largo, escritura->semilla);
+  size_t pos = (size_t)(h >> escritura->desplazamiento);
+  while (escritura->campos[pos].estado != SNAPSHOT_VACIO) pos = (pos + 1) & escritura->mascara;
+
+  snapshot_campo_t* campo = &escritura->campos[pos];
+  size_t desplazamiento;
+  // Con el '\0', asi hash_mapa_para_cada puede entregar la clave tal cual
+  if (!snapshot_agregar(&escritura->claves, &escritura->tam_claves, &escritura->reservado_claves, clave, largo + 1, &desplazamiento)){
+    escritura->ok = false;
+    return false;
+  }
+  campo->hash = h;
+  campo->clave = desplazamiento;
+  campo->largo = (uint32_t)largo;
+  campo->estado = SNAPSHOT_OCUPADO;
+  if (escritura->tam_dato == 0){
+    campo->dato = (uint64_t)(uintptr_t)dato;
+    return true;
+  }
+  if (dato == NULL){
+    campo->dato = SNAPSHOT_SIN_DATO;
+    return true;
+  }
+  if (!snapshot_agregar(&escritura->datos, &escritura->tam_datos, &escritura->reservado_datos, dato, escritura->tam_dato, &desplazamiento)){
+    escritura->ok = false;
+    return false;
+  }
+  // Relleno hasta el siguiente multiplo de 8
+  escritura->tam_datos = snapshot_alinear(escritura->tam_datos);
+  campo->dato = desplazamiento;
+  return true;
+}
+
+static bool snapshot_escribir(FILE* archivo, const snapshot_cabecera_t* cabecera, const snapshot_escritura_t* escritura){
+  size_t capacidad = (size_t)cabecera->capacidad;
+  return fwrite(cabecera, sizeof(snapshot_cabecera_t), 1, archivo) == 1
+      && fwrite(escritura->campos, sizeof(snapshot_campo_t), capacidad, archivo) == capacidad
+      && (escritura->tam_claves == 0 || fwrite(escritura->claves, 1, escritura->tam_claves, archivo) == escritura->tam_claves)
+      && (escritura->tam_datos == 0 || fwrite(escritura->datos, 1, escritura->tam_datos, archivo) == escritura->tam_datos);
+}
+
+/* Verifica que la cabecera sea de esta version y maquina y que todas las
+ * secciones entren en el archivo.
+ */
+static bool snapshot_cabecera_valida(const snapshot_cabecera_t* cabecera, size_t tam){
+  if (memcmp(cabecera->magia, SNAPSHOT_MAGIA, sizeof(cabecera->magia)) != 0) return false;
+  if (cabecera->version != SNAPSHOT_VERSION || cabecera->orden != SNAPSHOT_ORDEN) return false;
+  if (cabecera->tam_campo != sizeof(snapshot_campo_t)) return false;
+  uint64_t capacidad = cabecera->capacidad;
+  if (capacidad < SNAPSHOT_CAPACIDAD_MIN || (capacidad & (capacidad - 1)) != 0) return false;
+  if (cabecera->cantidad >= capacidad) return false;
+  if (capacidad > (tam - sizeof(snapshot_cabecera_t)) / sizeof(snapshot_campo_t)) return false;
+  if (cabecera->inicio_campos != sizeof(snapshot_cabecera_t)) return false;
+  if (cabecera->inicio_claves != cabecera->inicio_campos + capacidad * sizeof(snapshot_campo_t)) return false;
+  if (cabecera->tam_claves > tam - cabecera->inicio_claves) return false;
+  if (cabecera->inicio_datos != cabecera->inicio_claves + cabecera->tam_claves) return false;
+  return cabecera->tam_datos == tam - cabecera->inicio_datos;
+}
+
+/* Los desplazamientos del archivo se verifican antes de usarlos: un
+ * archivo corrupto da claves o datos faltantes, no lecturas fuera del
+ * mapeo.
+ */
+static bool mapa_clave_valida(const hash_mapa_t* mapa, const snapshot_campo_t* campo){
+  return campo->clave < mapa->tam_claves && campo->largo < mapa->tam_claves - campo->clave;
+}
+
+static const snapshot_campo_t* mapa_buscar(const hash_mapa_t* mapa, const char* clave, size_t largo){
+  uint64_t h = fhash_rapida(clave, largo, mapa->semilla);
+  size_t pos = (size_t)(h >> mapa->desplazamiento);
+  for (size_t i=0; i<=mapa->mascara && mapa->campos[pos].estado != SNAPSHOT_VACIO; i++){
+    const snapshot_campo_t* campo = &mapa->campos[pos];
+    if (campo->hash == h && campo->largo == largo && mapa_clave_valida(mapa, campo)
+        && memcmp(mapa->claves + campo->clave, clave, largo) == 0) return campo;
+    pos = (pos + 1) & mapa->mascara;
+  }
+  return NULL;
+}
+
+static void* mapa_dato(const hash_mapa_t* mapa, const snapshot_campo_t* campo){
+  if (mapa->tam_dato == 0) return (void*)(uintptr_t)campo->dato;
+  if (campo->dato >= mapa->tam_datos || mapa->tam_dato > mapa->tam_datos - campo->dato) return NULL;
+  return mapa->datos + campo->dato;
+}
+
+/* Escribe el snapshot en el archivo recien creado fd y lo cierra. Antes
+ * de cerrarlo lo baja a disco con fsync: si no, despues de un corte de
+ * luz el rename podria haber llegado al disco y los datos no, y ruta
+ * quedaria vacia o cortada.
+ */
+static bool snapshot_volcar(int fd, const snapshot_cabecera_t* cabecera, const snapshot_escritura_t* escritura){
+  // mkstemp crea el archivo con 0600; se deja legible como con fopen
+  bool ok = fchmod(fd, SNAPSHOT_PERMISOS) == 0;
+  FILE* archivo = fdopen(fd, "wb");
+  if (archivo == NULL){
+    close(fd);
+    return false;
+  }
+  ok = ok && snapshot_escribir(archivo, cabecera, escritura);
+  ok = ok && fflush(archivo) == 0 && fsync(fileno(archivo)) == 0;
+  return fclose(archivo) == 0 && ok;
+}
+
+/* ******************************************************************
+ *                       PRIMITIVAS DEL SNAPSHOT
+ * *****************************************************************/
+
+bool hash_guardar_snapshot(const hash_t *hash, const char *ruta, size_t tam_dato){
+  size_t cantidad = hash_cantidad(hash);
+  snapshot_escritura_t escritura = {0};
+  size_t capacidad = SNAPSHOT_CAPACIDAD_MIN;
+  escritura.desplazamiento = 63;
+  while (capacidad < 2 * cantidad + 1){
+    capacidad <<= 1;
+    escritura.desplazamiento--;
+  }
+  escritura.mascara = capacidad - 1;
+  escritura.tam_dato = tam_dato;
+  escritura.ok = true;
+  escritura.semilla = hash_semilla_aleatoria(&escritura);
+  escritura.campos = calloc(capacidad, sizeof(snapshot_campo_t));
+  if (escritura.campos == NULL) return false;
+  hash_para_cada(hash, snapshot_ubicar, &escritura);
+  // Relleno al final de las claves, para que los datos copiados queden
+  // alineados tambien en el archivo
+  char relleno[8] = {0};
+  size_t desplazamiento;
+  size_t tam_relleno = snapshot_alinear(escritura.tam_claves) - escritura.tam_claves;
+  if (tam_relleno > 0 && !snapshot_agregar(&escritura.claves, &escritura.tam_claves, &escritura.reservado_claves, relleno, tam_relleno, &desplazamiento)){
+    escritura.ok = false;
+  }
+
+  snapshot_cabecera_t cabecera;
+  memset(&cabecera, 0, sizeof(snapshot_cabecera_t));
+  memcpy(cabecera.magia, SNAPSHOT_MAGIA, sizeof(cabecera.magia));
+  cabecera.version = SNAPSHOT_VERSION;
+  cabecera.tam_campo = sizeof(snapshot_campo_t);
+  cabecera.orden = SNAPSHOT_ORDEN;
+  cabecera.capacidad = capacidad;
+  cabecera.cantidad = cantidad;
+  cabecera.semilla = escritura.semilla;
+  cabecera.tam_dato = tam_dato;
+  cabecera.inicio_campos = sizeof(snapshot_cabecera_t);
+  cabecera.inicio_claves = cabecera.inicio_campos + capacidad * sizeof(snapshot_campo_t);
+  cabecera.tam_claves = escritura.tam_claves;
+  cabecera.inicio_datos = cabecera.inicio_claves + escritura.tam_claves;
+  cabecera.tam_datos = escritura.tam_datos;
+
+  // Se escribe en un temporal de nombre unico junto a ruta, asi dos
+  // escrituras a la misma ruta no se pisan, y se renombra al terminar
+  size_t largo_ruta = strlen(ruta);
+  char* temporal = malloc(largo_ruta + sizeof(SNAPSHOT_TEMPORAL));
+  bool ok = escritura.ok && temporal != NULL;
+  if (ok){
+    memcpy(temporal, ruta, largo_ruta);
+    memcpy(temporal + largo_ruta, SNAPSHOT_TEMPORAL, sizeof(SNAPSHOT_TEMPORAL));
+    int fd = mkstemp(temporal);
+    ok = fd >= 0;
+    if (ok) ok = snapshot_volcar(fd, &cabecera, &escritura);
+    ok = ok && rename(temporal, ruta) == 0;
+    if (!ok && fd >= 0) remove(temporal);
+  }
+  free(temporal);
+  free(escritura.campos);
+  free(escritura.claves);
+  free(escritura.datos);
+  return ok;
+}
+
+hash_mapa_t *hash_cargar_mmap(const char *ruta){
+  int fd = open(ruta, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(snapshot_cabecera_t)){
+    close(fd);
+    return NULL;
+  }
+  size_t tam = (size_t)info.st_size;
+  void* mapeo = mmap(NULL, tam, PROT_READ, MAP_SHARED, fd, 0);
+  // El mapeo sigue siendo valido despues de cerrar el descriptor
+  close(fd);
+  if (mapeo == MAP_FAILED) return NULL;
+
+  const snapshot_cabecera_t* cabecera = mapeo;
+  hash_mapa_t* mapa = malloc(sizeof(hash_mapa_t));
+  if (mapa == NULL || !snapshot_cabecera_valida(cabecera, tam)){
+    free(mapa);
+    munmap(mapeo, tam);
+    return NULL;
+  }
+  mapa->mapeo = mapeo;
+  mapa->tam_mapeo = tam;
+  mapa->campos = (const snapshot_campo_t*)((const char*)mapeo + cabecera->inicio_campos);
+  mapa->claves = (const char*)mapeo + cabecera->inicio_claves;
+  mapa->datos = (char*)mapeo + cabecera->inicio_datos;
+  mapa->mascara = (size_t)cabecera->capacidad - 1;
+  mapa->desplazamiento = 64;
+  for (uint64_t c = cabecera->capacidad; c > 1; c >>= 1) mapa->desplazamiento--;
+  mapa->cantidad = (size_t)cabecera->cantidad;
+  mapa->semilla = cabecera->semilla;
+  mapa->tam_claves = cabecera->tam_claves;
+  mapa->tam_datos = cabecera->tam_datos;
+  mapa->tam_dato = cabecera->tam_dato;
+  return mapa;
+}
+
+void *hash_mapa_obtener(const hash_mapa_t *mapa, const char *clave){
+  return hash_mapa_obtener_n(mapa, clave, strlen(clave));
+}
+
+void *hash_mapa_obtener_n(const hash_mapa_t *mapa, const char *clave, size_t largo){
+  const snapshot_campo_t* campo = mapa_buscar(mapa, clave, largo);
+  return campo ? mapa_dato(mapa, campo) : NULL;
+}
+
+bool hash_mapa_pertenece(const hash_mapa_t *mapa, const char *clave){
+  return mapa_buscar(mapa, clave, strlen(clave)) != NULL;
+}
+
+bool hash_mapa_pertenece_n(const hash_mapa_t *mapa, const char *clave, size_t largo){
+  return mapa_buscar(mapa, clave, largo) != NULL;
+}
+
+size_t hash_mapa_cantidad(const hash_mapa_t *mapa){
+  return mapa->cantidad;
+}
+
+void hash_mapa_para_cada(const hash_mapa_t *mapa, bool visitar(const char *clave, size_t largo, void *dato, void *extra), void *extra){
+  for (size_t pos=0; pos<=mapa->mascara; pos++){
+    const snapshot_campo_t* campo = &mapa->campos[pos];
+    if (campo->estado == SNAPSHOT_VACIO) continue;
+    if (!mapa_clave_valida(mapa, campo)) continue;
+    if (!visitar(mapa->claves + campo->clave, campo->largo, mapa_dato(mapa, campo), extra)) return;
+  }
+}
+
+void hash_mapa_cerrar(hash_mapa_t *mapa){
+  munmap(mapa->mapeo, mapa->tam_mapeo);
+  free(mapa);
+}
@@ -0,0 +1,75 @@
+#ifndef HASH_SNAPSHOT_H
+#define HASH_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash.h"
+
+/* Snapshot binario de un hash, para volver a tenerlo después de reiniciar
+ * sin guardar las claves una por una. El archivo trae la tabla ya armada
+ * (sondeo lineal, con su propia semilla), las claves y los datos, todo con
+ * desplazamientos en lugar de punteros. hash_cargar_mmap lo mapea de solo
+ * lectura y las búsquedas leen directamente del mapeo: cargar no pide
+ * memoria por clave ni recalcula ningún hash.
+ *
+ * La tabla del archivo es propia del snapshot (sondeo lineal, a la mitad
+ * de carga como mucho), no una copia de la de hash_t: al cargarlo no se
+ * reproducen el modo de sondeo del hash original, los bytes de control
+ * del sondeo por grupos ni el modo congelado (el snapshot de un hash
+ * congelado es una tabla lineal como cualquier otra).
+ *
+ * Tampoco se guarda la función de hash: el snapshot siempre usa
+ * fhash_rapida con una semilla propia, sin importar la función o la
+ * función propia con que se creó el hash. Las claves se comparan byte a
+ * byte igual que en hash_t, así que las búsquedas dan lo mismo; lo único
+ * que no se conserva es la distribución de esa función (por ejemplo, una
+ * función elegida para que ciertas claves no colisionen).
+ *
+ * El archivo usa el orden de bytes y el tamaño de palabra de la máquina
+ * que lo escribió; cargarlo en otra distinta falla.
+ */
+struct hash_mapa;
+typedef struct hash_mapa hash_mapa_t;
+
+/* Escribe el snapshot de hash en ruta. Lo escribe en un temporal de nombre
+ * único en el mismo directorio, lo baja a disco con fsync y lo renombra:
+ * ruta nunca queda a medio escribir, ni siquiera después de un corte de
+ * luz, y dos escrituras simultáneas a la misma ruta no se pisan el
+ * temporal (queda la última en renombrar). El archivo queda con permisos
+ * 0644. Los datos son punteros, así que se guardan según tam_dato:
+ *  - 0: se guarda el valor del puntero tal cual. Sirve para datos que son
+ *    enteros o desplazamientos guardados como void*.
+ *  - mayor a 0: se copian tam_dato bytes de cada dato (los datos NULL
+ *    quedan NULL), y al cargar el dato apunta a esa copia dentro del mapeo.
+ * Devuelve false si no pudo escribirlo.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_snapshot(const hash_t *hash, const char *ruta, size_t tam_dato);
+
+/* Mapea de solo lectura el snapshot de ruta. Devuelve NULL si no existe o
+ * no es un snapshot válido para esta máquina.
+ */
+hash_mapa_t *hash_cargar_mmap(const char *ruta);
+
+/* Primitivas de consulta, equivalentes a las de hash_t. Con tam_dato
+ * mayor a 0 el dato devuelto apunta al mapeo: no se puede modificar ni
+ * liberar, y deja de ser válido al cerrar el mapa.
+ * Pre: El mapa fue cargado
+ */
+void *hash_mapa_obtener(const hash_mapa_t *mapa, const char *clave);
+void *hash_mapa_obtener_n(const hash_mapa_t *mapa, const char *clave, size_t largo);
+bool hash_mapa_pertenece(const hash_mapa_t *mapa, const char *clave);
+bool hash_mapa_pertenece_n(const hash_mapa_t *mapa, const char *clave, size_t largo);
+size_t hash_mapa_cantidad(const hash_mapa_t *mapa);
+
+/* Llama a visitar con cada elemento del mapa hasta que devuelva false.
+ * Pre: El mapa fue cargado
+ */
+void hash_mapa_para_cada(const hash_mapa_t *mapa, bool visitar(const char *clave, size_t largo, void *dato, void *extra), void *extra);
+
+/* Desmapea el archivo. Los datos de un snapshot con tam_dato mayor a 0 ya
+ * no se pueden usar.
+ */
+void hash_mapa_cerrar(hash_mapa_t *mapa);
+
+#endif // HASH_SNAPSHOT_H